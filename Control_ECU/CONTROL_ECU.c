@@ -9,6 +9,8 @@
 
 static uint8 g_fail_count = MAX_FAIL_TRIALS;
 static uint8 g_Passwrod_Status = PASS_UNMATCH;
+static uint8 g_Password_Saved = FALSE;
+static uint8 g_Users_Session = FALSE;			/* TRUE while the master password opened the user table */
 
 
 /*-------------------------------------------------------------------------------------------------------
@@ -28,18 +30,34 @@ int main (void)
 	DcMotor_Init();
 
 	/* UART Initialization
-	 * 1- Baud Rate : 9600
-	 * 2- Data Bits : 8
+	 * 1- Baud Rate : 9600 (UART_START_BAUD, stepped up by the HMI after the handshake)
+	 * 2- Data Bits : 8 (9 on the MPCM bus)
 	 * 3- Parity	: Disable
 	 * 4- Stop Bits : 1
+	 * 5- Mode		: Interrupt driven (bytes are buffered while EEPROM/motor work is running)
 	 */
 	UART_ConfigType UART_Config;
-	UART_Config.BaudRate = Baud_9600;
-	UART_Config.DataBits = Data_8;
+	UART_BAUD_ASSERT(UART_START_BAUD);
+	UART_Config.BaudRate = UART_START_BAUD;
+	UART_Config.DataBits = (UART_MPCM_BUS) ? Data_9 : Data_8;
 	UART_Config.ParityMode = Parity_Disable;
 	UART_Config.StopBits = StopBits_1;
+	UART_Config.Mode = UART_INTERRUPT_MODE;
 	UART_init(&UART_Config);
 
+#if (UART_MPCM_BUS)
+	/* Skips in hardware all the traffic until HMI addresses this door */
+	UART_setNodeAddress(CONTROL_NODE_ADDRESS);
+#endif
+
+	SREG |= (1<<7);												/* Enables I-bit for UART */
+
+	/* 1 ms time base on Timer0 for the link deadlines */
+	Timebase_init();
+
+	/* Reliable link (frames with sequence numbers, ACKs and retransmission) to the HMI ECU */
+	LINK_init();
+
 
 	/* I2C Initialization
 	 * 1- I2C Rate  	: 400KHz
@@ -50,20 +68,41 @@ int main (void)
 	TWI_ConfigType TWI_Config  = { 400000, 0x02, TWI_PRESCALAR_1};
 	TWI_init(&TWI_Config);
 
+	/* Newest credential record of the EEPROM log read once, the password checks are served from SRAM.
+	 * The first time setup is skipped if a valid record exists (HMI is told in CONTROL_ECU_READY) */
+	g_Password_Saved = CACHE_init();
+
+	/* SRAM index of the user table built from one read of the table */
+	USERS_init();
 
-	/*	Waits Until the other MCU is ready to communicate */
-	while(UART_receiveByte() != HMI_ECU_READY){}
-	UART_sendByte(CONTROL_ECU_READY);
+	/* Fail trials survive a reset (hot tier), an alarm cut by a reset leaves one trial before the next one.
+	 * HMI gets the count in CONTROL_ECU_READY */
+	if(!STORE_loadFailCount(&g_fail_count) || (g_fail_count > MAX_FAIL_TRIALS))
+	{
+		g_fail_count = MAX_FAIL_TRIALS;
+	}
+	else if(g_fail_count == 0)
+	{
+		g_fail_count = 1;
+	}
+
+
+	/*	Waits Until the other MCU is ready to communicate (HMI_ECU_READY is answered in receive_frame) */
+	Frame_Type frame;
+	while(receive_frame(HMI_ECU_READY, &frame, WAIT_FOREVER) != WAIT_OK){}
 
 	uint8 status = ERROR;
+	uint8 result;
 	uint8 key = 0;
 	uint8 i;
 
 	/****************************************	SUPER LOOP	****************************************/
+	/* Any wait that times out or is interrupted by a new HMI handshake (WAIT_RESYNC) ends the current
+	 * transaction and the loop starts again from the first time setup or the main options */
 	for(;;)
 	{
 		/* Loop for Max fail trials in New Password mode */
-		while(status != PASS)
+		while(g_Password_Saved == FALSE)
 		{
 			/* RESET Strings if doesn't match to avoid errors*/
 			for(i=0 ; i<MAX_PASSWORD ; ++i)
@@ -72,61 +111,203 @@ int main (void)
 				entered_password[i] = 0;
 			}
 
-			receive_Password(pass1);				/* Saves First entry password in first array */
-			receive_Password(entered_password);				/* Saves Second entry password in second array */
+			if(receive_Password(pass1) != WAIT_OK)					/* Saves First entry password in first array */
+				continue;
+			if(receive_Password(entered_password) != WAIT_OK)		/* Saves Second entry password in second array */
+				continue;
 			status = Pass_Compare(pass1,entered_password);		/* Compares first and second password matching*/
+			if(status == PASS)
+			{
+				/* Saves Password if entry matches */
+				save_password(pass1);
+				g_Password_Saved = TRUE;
+			}
 		}
-		/* Saves Password if entry matches */
-		save_password(pass1);
 
 		/* Variable that holds the received mode by UART mode '+' or '-' */
-		key = UART_receiveByte();
-		if(key == '-')														/* Open Door */
+		if(receive_frame(MAIN_OPTIONS, &frame, WAIT_FOREVER) != WAIT_OK)
+			continue;
+		if(frame.length < 1)
+			continue;
+		key = frame.payload[0];
+		if((key != '-') && (key != '+') && (key != MAIN_OPTION_USERS))
+			continue;
+
+		/* Keeps checking the entered password until it matches or the alarm/resync ends this try */
+		g_Passwrod_Status = PASS_UNMATCH;
+		result = WAIT_OK;
+		while((g_Passwrod_Status == PASS_UNMATCH) && (result == WAIT_OK))
 		{
-			while(g_Passwrod_Status == PASS_UNMATCH)
+			result = receive_Password(entered_password);
+			if(result == WAIT_OK)
 			{
-				while (UART_receiveByte() != HMI_ECU_READY);
-				receive_Password(entered_password);
-				check_password(entered_password, pass1);					/* Check Password */
+				result = check_password(entered_password, key);	/* Check Password */
 			}
+		}
+		if(g_Passwrod_Status == PASS_UNMATCH)
+			continue;
+
+		if(key == '-')														/* Open Door */
+		{
 			/* Calls open door function if password match */
 			openDoor();
 		}
-		else if(key == '+')
+		else if(key == MAIN_OPTION_USERS)									/* User table admin */
+		{
+			users_session();
+		}
+		else
 		{
-			while(g_Passwrod_Status == PASS_UNMATCH)
-			{
-				while (UART_receiveByte() != HMI_ECU_READY);
-				receive_Password(entered_password);
-				check_password(entered_password, pass1);					/* Check Password */
-			}
 			/* Calls change password function if password match */
 			changePassword(entered_password, pass1);
 		}
 	}
 }
 
-
 /*-------------------------------------------------------------------------------------------------------
- * [Description]:	Function that receives password form HMI with UART and stores it in array
+ * [Description]:	Function that waits up to timeout_ms (or WAIT_FOREVER) for a frame of the required
+ * 					type from HMI ECU:
+ * 					- HMI_ECU_READY starts a new link session and is always answered with
+ * 					  CONTROL_ECU_READY. If another type is awaited the HMI has restarted the session
+ * 					  so WAIT_RESYNC is returned.
+ * 					- BAUD_REQUEST / BAUD_CONFIRM (baud rate step up) are answered here.
+ * 					- TRACE_DUMP is answered with the UART trace (UART_TRACE = 1).
+ * 					- USER_ADD / USER_REMOVE run on the user table in an admin session,
+ * 					  they are denied outside it (user_command).
+ * 					- Repeated frames are dropped by the link layer.
+ * 					- While waiting forever the background EEPROM write is polled and a failed write
+ * 					  back of the credential cache or load of the user table is retried every
+ * 					  WAIT_RETRY_MS.
+ * 					Returns WAIT_OK, WAIT_TIMEOUT (deadline expired or link error) or WAIT_RESYNC.
  *------------------------------------------------------------------------------------------------------*/
-void receive_Password(uint8 *password)
+uint8 receive_frame(uint8 type, Frame_Type *frame, uint16 timeout_ms)
 {
-	uint8 i = 0, flag_pass=0;
+	uint32 start = Timebase_getMs();
+	uint16 elapsed = 0;
+	uint8 setup_state[2];
+	uint8 received;
 
-	/* Keeps storing password in array passed until key sent is enter (=) */
-	while(flag_pass == 0)
+	for(;;)
 	{
-		password[i] = UART_receiveByte();
-		if(password[i] == '=')
+		if(timeout_ms == WAIT_FOREVER)
 		{
-			flag_pass = 1;
-			password[i] = '\0';
-			++i;
-			break;
+			/* The background EEPROM write is polled while waiting on the user. A write back of the
+			 * credential cache or a load of the user table that failed is retried once it ended, never in
+			 * a PIN check */
+			received = FALSE;
+			while(!received && (EEPROM_isPending() || CACHE_isDirty() || !USERS_isLoaded()))
+			{
+				received = LINK_receiveTimeout(frame, EEPROM_isPending() ? EEPROM_POLL_INTERVAL_MS : WAIT_RETRY_MS);
+				if(!received)
+				{
+					if(LINK_isError())
+					{
+						return WAIT_TIMEOUT;
+					}
+					if(!EEPROM_isPending())
+					{
+						CACHE_flush();
+						if(!USERS_isLoaded())
+						{
+							USERS_init();
+						}
+					}
+				}
+			}
+			if(!received && !LINK_receive(frame))
+			{
+				return WAIT_TIMEOUT;						/* Only the HMI handshake clears a link error */
+			}
 		}
-		++i;
+		else if(!LINK_receiveTimeout(frame, timeout_ms - elapsed))
+		{
+			return WAIT_TIMEOUT;
+		}
+
+		if(frame->type == HMI_ECU_READY)
+		{
+			/* The handshake isn't sent through the link, it starts a new session on both sides.
+			 * HMI may have sent it at the stepped up rate, the answer goes back at the same rate then
+			 * both ECUs return to UART_START_BAUD */
+			LINK_reset();
+			setup_state[0] = g_Password_Saved;
+			setup_state[1] = g_fail_count;				/* Restored from the hot tier after a reset */
+			FRAME_send(CONTROL_ECU_READY, setup_state, 2);
+			UART_setBaudRate(UART_START_BAUD);
+			return (type == HMI_ECU_READY) ? WAIT_OK : WAIT_RESYNC;
+		}
+		else if(frame->type == BAUD_REQUEST)
+		{
+			LINK_acceptBaud(frame);							/* Baud rate step up after the handshake */
+		}
+		else if(frame->type == BAUD_CONFIRM)
+		{
+			FRAME_send(BAUD_CONFIRM, NULL_PTR, 0);			/* Repeated confirm, our answer was lost */
+		}
+		else if((frame->type == USER_ADD) || (frame->type == USER_REMOVE))
+		{
+			user_command(frame);							/* Denied outside an admin session */
+		}
+#if (DIGEST_BENCHMARK)
+		else if(frame->type == DIGEST_BENCH)
+		{
+			digest_benchmark();
+		}
+#endif
+#if (UART_TRACE)
+		else if(frame->type == TRACE_DUMP)
+		{
+			/* Recording stays paused while the HMI sends its own trace, until its TRACE_END */
+			FRAME_traceDump(TRACE_ECU_CONTROL);
+			UART_traceEnable(FALSE);
+		}
+		else if(frame->type == TRACE_END)
+		{
+			UART_traceEnable(TRUE);
+		}
+#endif
+		else if(frame->type == type)
+		{
+			return WAIT_OK;
+		}
+
+		elapsed = (uint16)(Timebase_getMs() - start);
+		if((timeout_ms != WAIT_FOREVER) && (elapsed >= timeout_ms))
+		{
+			return WAIT_TIMEOUT;
+		}
+	}
+}
+
+
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]:	Function that receives a PASSWORD frame from HMI with UART and stores it in array
+ * 					as a null terminated string
+ *------------------------------------------------------------------------------------------------------*/
+uint8 receive_Password(uint8 *password)
+{
+	Frame_Type frame;
+	uint8 i;
+	uint8 result;
+
+	/* The whole password arrives in one frame, the user can take any time to type it */
+	result = receive_frame(PASSWORD, &frame, WAIT_FOREVER);
+	if(result != WAIT_OK)
+	{
+		return result;
+	}
+
+	/* Keep one place for the null at the end of the password */
+	if(frame.length > (MAX_PASSWORD - 1))
+	{
+		frame.length = MAX_PASSWORD - 1;
+	}
+	for(i=0 ; i<frame.length ; ++i)
+	{
+		password[i] = frame.payload[i];
 	}
+	password[i] = '\0';
+	return WAIT_OK;
 }
 
 /*-------------------------------------------------------------------------------------------------------
@@ -135,94 +316,104 @@ void receive_Password(uint8 *password)
  *------------------------------------------------------------------------------------------------------*/
 uint8 Pass_Compare(uint8 *pass1, uint8 *entered_password)
 {
+	uint8 difference = 0;
 	uint8 i;
 
+	/* Every digit is compared, the time doesn't tell where the passwords differ */
 	for(i=0 ; i < MAX_PASSWORD ; ++i)
 	{
-		if(pass1[i] != entered_password[i])
-		{
-			UART_sendByte(PASS_UNMATCH);		/* Tells HMI ECU that passwords doesn't match */
-			return ERROR;
-		}
+		difference |= pass1[i] ^ entered_password[i];
 	}
-	UART_sendByte(PASS_MATCH);					/* Tells HMI ECU that passwords match */
+	if(difference != 0)
+	{
+		LINK_send(PASS_UNMATCH, NULL_PTR, 0);		/* Tells HMI ECU that passwords doesn't match */
+		return ERROR;
+	}
+	LINK_send(PASS_MATCH, NULL_PTR, 0);				/* Tells HMI ECU that passwords match */
 	return PASS;
 }
 
 /*-------------------------------------------------------------------------------------------------------
- * [Description]:	Function that saves the password in EEPROM that uses I2C communication protocol
+ * [Description]:	Function that saves the password in EEPROM that uses I2C communication protocol,
+ * 					through the SRAM cache (only the changed bytes are written back). Only a new salt
+ * 					and the salted digest of the password are saved, never the digits
  *------------------------------------------------------------------------------------------------------*/
 void save_password(uint8 *password)
 {
+	uint8 record[DIGEST_SALT_SIZE + DIGEST_SIZE];		/* | SALT | DIGEST | */
 	uint8 i = 0;
-	/* Saves password characters until null*/
-	while(password[i] != '\0')
+	/* Counts password characters until null*/
+	while((i < (MAX_PASSWORD - 1)) && (password[i] != '\0'))
 	{
-		/* Saves Password in the following address and increment address*/
-		EEPROM_writeByte((0xF000+i), password[i]);
 		++i;
 	}
-	/*	Saves null as an indication for password end */
-	EEPROM_writeByte((0xF000+i), '\0');
+	password[i] = '\0';
+	DIGEST_newSalt(record);
+	DIGEST_compute(record, password, i, &record[DIGEST_SALT_SIZE]);
+	CACHE_write(0, record, DIGEST_SALT_SIZE + DIGEST_SIZE);
+	/* Saved in the hot tier now, written back to the cold tier in the background so the UART and the link
+	 * keep running during the write cycle. If it can't start or fails the cache stays dirty and is flushed
+	 * again by receive_frame until it succeeds, the result isn't needed here */
+	CACHE_flush();
 }
 
 
 /*-------------------------------------------------------------------------------------------------------
  * [Description]:	Function that checks if the entered password is correct with the password saved
- * 					in the EEPROM by reading password stored in EEPROM and comparing to received one
+ * 					in the EEPROM: its digest with the saved salt is compared in constant time to the
+ * 					saved digest (SRAM cache of the EEPROM). To open the door ('-') the PIN of a user of
+ * 					the table is accepted too, the other options need the master password
  *------------------------------------------------------------------------------------------------------*/
-void check_password(uint8 *entered_password, uint8 *Saved_Password)
+uint8 check_password(uint8 *entered_password, uint8 key)
 {
-	uint8 i = 0;
+	Frame_Type frame;
+	uint8 record[DIGEST_SALT_SIZE + DIGEST_SIZE];		/* | SALT | DIGEST | */
+	uint8 digest[DIGEST_SIZE];
+	uint8 result = WAIT_OK;
+	uint8 length = 0;
 	uint8 status = 0;		/* status that indicates if password comparison is matching[0] or not[1] */
-	while(Saved_Password[i] != '\0')
+	while((length < (MAX_PASSWORD - 1)) && (entered_password[length] != '\0'))
 	{
-		EEPROM_readByte((0x100+i), &Saved_Password[i]);
-		if(Saved_Password[i] != entered_password[i])
-		{
-			status = 1;
-			break;											/* If un-match in numbers don't loop to the end */
-		}
-		else
-		{
-			status = 0;
-		}
-		++i;
+		++length;
+	}
+	/* The length is hashed too: Saved Pass = 245, entered password 2457 doesn't match */
+	CACHE_read(0, record, DIGEST_SALT_SIZE + DIGEST_SIZE);
+	DIGEST_compute(record, entered_password, length, digest);
+	status = DIGEST_equal(digest, &record[DIGEST_SALT_SIZE]) ? 0 : 1;
+	if((status == 1) && (key == '-') && (USERS_verify(entered_password, length) != USERS_NO_USER))
+	{
+		status = 0;
 	}
-	/* Check that entered password matches with saved password till the end for example
-	 * Saved Pass = 245, entered password 2457 ( Will Match without the next code ).
-	 */
-	if(Saved_Password[i] != entered_password[i])
-			{
-				status = 1;		/* Password end doesn't match */
-			}
-			else
-			{
-				status = 0;		/* Password end match */
-			}
-
 
 	/* Password end match */
 	if(status == 0)
 	{
-		UART_sendByte(PASS_MATCH);			/* Send to HMI control Match */
+		LINK_send(PASS_MATCH, NULL_PTR, 0);		/* Send to HMI control Match */
 		g_Passwrod_Status = PASS_MATCH;		/* Saves status in global variable to stop matching password again */
 
 	}
 	else
 	{
-		UART_sendByte(PASS_UNMATCH);
+		LINK_send(PASS_UNMATCH, NULL_PTR, 0);
 		g_Passwrod_Status = PASS_UNMATCH;
 		--g_fail_count;										/* decrement fail trials if password didn't match */
+		STORE_saveFailCount(g_fail_count);
 		if(g_fail_count == 0)
 		{
 			buzzerOn();										/* Activates buzzer */
-			while(UART_receiveByte() != TIME_60_SEC);		/* Waits 60 seconds */
+			/* Waits 60 seconds, the buzzer is switched off at the deadline even if HMI is lost */
+			result = receive_frame(TIME_60_SEC, &frame, ALARM_TIMEOUT_MS);
 			buzzerOff();									/* De-activates buzzer */
-			UART_sendByte(CONTROL_ECU_READY);
+			if(result == WAIT_OK)
+			{
+				LINK_send(CONTROL_ECU_READY, NULL_PTR, 0);
+				result = WAIT_DONE;							/* HMI goes back to main options */
+			}
 			g_fail_count = MAX_FAIL_TRIALS;					/* reset max fail trials */
+			STORE_saveFailCount(g_fail_count);
 		}
 	}
+	return result;
 }
 
 /*-------------------------------------------------------------------------------------------------------
@@ -232,16 +423,25 @@ void check_password(uint8 *entered_password, uint8 *Saved_Password)
  *------------------------------------------------------------------------------------------------------*/
 void openDoor()
 {
+	Frame_Type frame;
+
 	DcMotor_Rotate(CW);
-	UART_sendByte(START_TIME_15_SEC);
-	while(UART_receiveByte() != TIME_15_SEC);
-	UART_sendByte(CONTROL_ECU_READY);
-	DcMotor_Rotate(STOP);
-	while(UART_receiveByte() != TIME_3_SEC);
-	UART_sendByte(CONTROL_ECU_READY);
-	DcMotor_Rotate(ACW);
-	while(UART_receiveByte() != TIME_15_SEC);
-	UART_sendByte(CONTROL_ECU_READY);
+	LINK_send(START_TIME_15_SEC, NULL_PTR, 0);
+	if(receive_frame(TIME_15_SEC, &frame, DOOR_MOVE_TIMEOUT_MS) == WAIT_OK)
+	{
+		LINK_send(CONTROL_ECU_READY, NULL_PTR, 0);
+		DcMotor_Rotate(STOP);
+		if(receive_frame(TIME_3_SEC, &frame, DOOR_HOLD_TIMEOUT_MS) == WAIT_OK)
+		{
+			LINK_send(CONTROL_ECU_READY, NULL_PTR, 0);
+			DcMotor_Rotate(ACW);
+			if(receive_frame(TIME_15_SEC, &frame, DOOR_MOVE_TIMEOUT_MS) == WAIT_OK)
+			{
+				LINK_send(CONTROL_ECU_READY, NULL_PTR, 0);
+			}
+		}
+	}
+	/* Motor is stopped at the end or as soon as a deadline expires (HMI lost) */
 	DcMotor_Rotate(STOP);
 	g_Passwrod_Status = PASS_UNMATCH;
 }
@@ -252,23 +452,88 @@ void openDoor()
  *------------------------------------------------------------------------------------------------------*/
 void changePassword(uint8 *newPassword, uint8 *pass1)
 {
-	uint8 i = 0, flag_pass=0;
-	while(flag_pass == 0)
+	uint8 i;
+
+	/* Keeps the old password if HMI restarted the session before sending the new one */
+	if(receive_Password(newPassword) == WAIT_OK)
 	{
-		newPassword[i] = UART_receiveByte();
-		if(newPassword[i]>=0 && newPassword[i] <= 9)
+		for(i=0 ; i<MAX_PASSWORD ; ++i)
 		{
-			pass1[i-1] = newPassword[i];
+			pass1[i] = newPassword[i];
 		}
-		else if(newPassword[i] == '=' && i>0)
+		save_password(pass1);
+	}
+	g_Passwrod_Status = PASS_UNMATCH;
+}
+
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]:	Function that runs a USER_ADD or USER_REMOVE frame of HMI on the user table if an admin
+ * 					session is open (USERS_DENIED otherwise) and answers with USER_RESULT (result and user ID)
+ *------------------------------------------------------------------------------------------------------*/
+void user_command(const Frame_Type *frame)
+{
+	uint8 reply[3];
+	uint16 user_id = USERS_NO_USER;
+	uint8 result = USERS_ERROR;
+
+	if(frame->length >= 2)
+	{
+		user_id = frame->payload[0] | ((uint16)frame->payload[1] << 8);
+	}
+	if(!g_Users_Session)
+	{
+		result = USERS_DENIED;
+	}
+	else if(frame->length >= 2)
+	{
+		if(frame->type == USER_ADD)
 		{
-			flag_pass = 1;
-			pass1[i-1] = '\0';
-			++i;
-			break;
+			result = USERS_add(user_id, &frame->payload[2], frame->length - 2);
+		}
+		else
+		{
+			result = USERS_remove(user_id);
 		}
-		++i;
 	}
-	save_password(pass1);
+	reply[0] = result;
+	reply[1] = (uint8)user_id;
+	reply[2] = (uint8)(user_id >> 8);
+	LINK_send(USER_RESULT, reply, 3);
+}
+
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]:	Function that opens the admin session of the user table after the master password
+ * 					matched: USER_ADD / USER_REMOVE are run (in receive_frame) until USER_END or
+ * 					USERS_SESSION_TIMEOUT_MS
+ *------------------------------------------------------------------------------------------------------*/
+void users_session(void)
+{
+	Frame_Type frame;
+
+	g_Users_Session = TRUE;
+	receive_frame(USER_END, &frame, USERS_SESSION_TIMEOUT_MS);
+	g_Users_Session = FALSE;
 	g_Passwrod_Status = PASS_UNMATCH;
 }
+
+#if (DIGEST_BENCHMARK)
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]:	Function that measures the digest of the longest password and a whole password check
+ * 					(digest and constant time compare) in CPU cycles and sends them to HMI in DIGEST_BENCH
+ *------------------------------------------------------------------------------------------------------*/
+void digest_benchmark(void)
+{
+	uint8 reply[8];
+	uint32 hash_cycles;
+	uint32 verify_cycles;
+	uint8 i;
+
+	DIGEST_benchmark(MAX_PASSWORD - 1, &hash_cycles, &verify_cycles);
+	for(i=0 ; i<4 ; ++i)
+	{
+		reply[i] = (uint8)(hash_cycles >> (8 * i));
+		reply[i + 4] = (uint8)(verify_cycles >> (8 * i));
+	}
+	LINK_send(DIGEST_BENCH, reply, 8);
+}
+#endif
@@ -7,29 +7,23 @@
 #define CONTROL_ECU_H_
 
 #include "uart.h"
+#include "link.h"
+#include "timebase.h"
 #include "gpio.h"
 #include "dc_motor.h"
 #include "external_eeprom.h"
+#include "credential_cache.h"
+#include "digest.h"
+#include "user_table.h"
 #include "std_types.h"
 #include "util/delay.h"
 #include "twi.h"
 #include "common_macros.h"
 #include "buzzer.h"
+#include <avr/io.h>
 
 
-/*********************************************UART MESSAGES**********************************************/
-
-#define CONTROL_ECU_READY 	0x10
-#define HMI_ECU_READY		0x11
-#define PASS_MATCH			0x12
-#define PASS_UNMATCH		0x13
-#define MAIN_OPTIONS		0x14
-#define TIME_15_SEC			0x15
-#define START_TIME_15_SEC	0x16
-#define START_TIME_3_SEC	0x17
-#define TIME_3_SEC			0x18
-#define TIME_60_SEC			0x19
-#define START_TIME_60_SEC	0x20
+/* UART messages are sent through the reliable link, the frame types are shared with the HMI ECU in frame.h */
 
 /***********************************************DEFINES************************************************/
 
@@ -38,15 +32,72 @@
 #define MAX_PASSWORD		15
 #define MAX_FAIL_TRIALS		3
 
+#if ((DIGEST_SALT_SIZE + DIGEST_SIZE) > CACHE_REGION_SIZE)
+#error "The salt and the digest of the password must fit in the credential region of the EEPROM cache"
+#endif
+
+/* Address of this door on the MPCM bus (UART_MPCM_BUS = 1), set per node with -DCONTROL_NODE_ADDRESS=<n>
+ * ( 1 -> HMI_MAX_DOORS, every node on the bus needs a different address ) */
+#ifndef CONTROL_NODE_ADDRESS
+#define CONTROL_NODE_ADDRESS	1
+#endif
+
+/* Results of waiting for a frame from HMI ECU */
+#define WAIT_OK				0		/* Frame received, transaction goes on */
+#define WAIT_TIMEOUT		1		/* Deadline expired, transaction aborted */
+#define WAIT_RESYNC			2		/* HMI restarted the session, transaction aborted */
+#define WAIT_DONE			3		/* Transaction finished (alarm ended) */
+#define WAIT_FOREVER		0		/* Timeout value for waits on the user (no deadline) */
+
+/* Deadlines of the HMI timer frames: HMI timer period + time the link needs to deliver the frame with
+ * retransmissions + margin for the HMI LCD messages. The motor/buzzer are switched off at the deadline. */
+#define WAIT_MARGIN_MS			3000
+#define DOOR_MOVE_TIMEOUT_MS	(15000 + LINK_WORST_DELIVERY_MS + WAIT_MARGIN_MS)
+#define DOOR_HOLD_TIMEOUT_MS	(3000 + LINK_WORST_DELIVERY_MS + WAIT_MARGIN_MS)
+#define ALARM_TIMEOUT_MS		(60000UL + LINK_WORST_DELIVERY_MS + WAIT_MARGIN_MS)
+
+/* Period of the retries of the EEPROM work that failed ( credential cache write back, user table load )
+ * while waiting on the user ( receive_frame ) */
+#define WAIT_RETRY_MS			1000
+
+/* Longest admin session of the user table ( MAIN_OPTION_USERS ) from the master password to USER_END */
+#define USERS_SESSION_TIMEOUT_MS	60000
+
+#if (ALARM_TIMEOUT_MS > 65535)
+#error "ALARM_TIMEOUT_MS doesn't fit the 16-bit wait timeout"
+#endif
+
 /*****************************************FUNCTIONS DECLARATIONS******************************************/
 
 /*-------------------------------------------------------------------------------------------------------
- * [Description]:	Function that receives password form HMI with UART and stores it in array
+ * [Description]:	Function that waits up to timeout_ms (or WAIT_FOREVER) for a frame of the required
+ * 					type from HMI ECU:
+ * 					- HMI_ECU_READY starts a new link session and is always answered with
+ * 					  CONTROL_ECU_READY. If another type is awaited the HMI has restarted the session
+ * 					  so WAIT_RESYNC is returned.
+ * 					- BAUD_REQUEST / BAUD_CONFIRM (baud rate step up) are answered here.
+ * 					- TRACE_DUMP is answered with the UART trace (UART_TRACE = 1).
+ * 					- USER_ADD / USER_REMOVE run on the user table in an admin session,
+ * 					  they are denied outside it (user_command).
+ * 					- DIGEST_BENCH is answered with the digest cycles (DIGEST_BENCHMARK = 1).
+ * 					- Repeated frames are dropped by the link layer.
+ * 					- While waiting forever the background EEPROM write is polled and a failed write
+ * 					  back of the credential cache or load of the user table is retried every
+ * 					  WAIT_RETRY_MS.
+ * 					Returns WAIT_OK, WAIT_TIMEOUT (deadline expired or link error) or WAIT_RESYNC.
  *------------------------------------------------------------------------------------------------------*/
-void receive_Password(uint8 *password);
+uint8 receive_frame(uint8 type, Frame_Type *frame, uint16 timeout_ms);
 
 /*-------------------------------------------------------------------------------------------------------
- * [Description]:	Function that saves the password in EEPROM that uses I2C communication protocol
+ * [Description]:	Function that receives a PASSWORD frame from HMI with UART and stores it in array
+ * 					as a null terminated string. Returns WAIT_OK, WAIT_TIMEOUT (link error) or WAIT_RESYNC
+ *------------------------------------------------------------------------------------------------------*/
+uint8 receive_Password(uint8 *password);
+
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]:	Function that saves the password in EEPROM that uses I2C communication protocol,
+ * 					through the SRAM cache (only the changed bytes are written back). Only a new salt
+ * 					and the salted digest of the password are saved, never the digits
  *------------------------------------------------------------------------------------------------------*/
 void save_password(uint8 *pass);
 
@@ -59,13 +110,16 @@ void openDoor();
 
 /*-------------------------------------------------------------------------------------------------------
  * [Description]:	Function that checks if the entered password is correct with the password saved
- * 					in the EEPROM by reading password stored in EEPROM and comparing to received one
+ * 					in the EEPROM: its digest with the saved salt is compared in constant time to the
+ * 					saved digest (SRAM cache of the EEPROM). To open the door ('-') the PIN of a user of
+ * 					the table is accepted too, the other options need the master password.
+ * 					Returns WAIT_OK if HMI can try again, otherwise the result of the alarm wait
  *------------------------------------------------------------------------------------------------------*/
-void check_password(uint8 *entered_password, uint8 *Saved_Password);
+uint8 check_password(uint8 *entered_password, uint8 key);
 
 /*-------------------------------------------------------------------------------------------------------
  * [Description]:	Function that saves the new password in array Pass1 as the new password is received
- * 					with UART from HMI ECU
+ * 					in a PASSWORD frame with UART from HMI ECU
  *------------------------------------------------------------------------------------------------------*/
 void changePassword(uint8 *newPassword, uint8 *savedPass);
 
@@ -75,6 +129,26 @@ void changePassword(uint8 *newPassword, uint8 *savedPass);
  *------------------------------------------------------------------------------------------------------*/
 uint8 Pass_Compare(uint8 *pass1, uint8 *pass2);
 
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]:	Function that runs a USER_ADD or USER_REMOVE frame of HMI on the user table if an admin
+ * 					session is open (USERS_DENIED otherwise) and answers with USER_RESULT (result and user ID)
+ *------------------------------------------------------------------------------------------------------*/
+void user_command(const Frame_Type *frame);
+
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]:	Function that opens the admin session of the user table after the master password
+ * 					matched: USER_ADD / USER_REMOVE are run until USER_END or USERS_SESSION_TIMEOUT_MS
+ *------------------------------------------------------------------------------------------------------*/
+void users_session(void);
+
+#if (DIGEST_BENCHMARK)
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]:	Function that measures the digest of the longest password and a whole password check
+ * 					(digest and constant time compare) in CPU cycles and sends them to HMI in DIGEST_BENCH
+ *------------------------------------------------------------------------------------------------------*/
+void digest_benchmark(void);
+#endif
+
 
 
 
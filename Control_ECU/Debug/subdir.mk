@@ -6,32 +6,62 @@
 C_SRCS += \
 ../CONTROL_ECU.c \
 ../buzzer.c \
+../crc.c \
+../credential_cache.c \
+../credential_store.c \
 ../dc_motor.c \
+../digest.c \
+../entropy.c \
 ../external_eeprom.c \
+../frame.c \
 ../gpio.c \
 ../lcd.c \
+../link.c \
+../timebase.c \
+../timer.c \
 ../twi.c \
-../uart.c 
+../uart.c \
+../user_table.c 
 
 OBJS += \
 ./CONTROL_ECU.o \
 ./buzzer.o \
+./crc.o \
+./credential_cache.o \
+./credential_store.o \
 ./dc_motor.o \
+./digest.o \
+./entropy.o \
 ./external_eeprom.o \
+./frame.o \
 ./gpio.o \
 ./lcd.o \
+./link.o \
+./timebase.o \
+./timer.o \
 ./twi.o \
-./uart.o 
+./uart.o \
+./user_table.o 
 
 C_DEPS += \
 ./CONTROL_ECU.d \
 ./buzzer.d \
+./crc.d \
+./credential_cache.d \
+./credential_store.d \
 ./dc_motor.d \
+./digest.d \
+./entropy.d \
 ./external_eeprom.d \
+./frame.d \
 ./gpio.d \
 ./lcd.d \
+./link.d \
+./timebase.d \
+./timer.d \
 ./twi.d \
-./uart.d 
+./uart.d \
+./user_table.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
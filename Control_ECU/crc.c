@@ -0,0 +1,50 @@
+/******************************************************************************************************
+File Name	: crc.c
+Author		: Sherif Beshr
+Description : Source file for the CRC functions of the records saved in the EEPROMs ( bitwise, no
+			  table in flash or SRAM, the records are short )
+*******************************************************************************************************/
+
+#include "crc.h"
+
+/*
+ * Description :
+ * Returns the CRC-8 ( polynomial 0x07, initial value 0x00 ) of length bytes.
+ */
+uint8 CRC_8(const uint8 *data, uint8 length)
+{
+	uint8 crc = 0;
+	uint8 i;
+	uint8 bit;
+
+	for(i=0 ; i<length ; ++i)
+	{
+		crc ^= data[i];
+		for(bit=0 ; bit<8 ; ++bit)
+		{
+			crc = (crc & 0x80) ? ((crc << 1) ^ CRC8_POLY) : (crc << 1);
+		}
+	}
+	return crc;
+}
+
+/*
+ * Description :
+ * Returns the CRC-16/CCITT ( polynomial 0x1021, initial value 0xFFFF ) of length bytes.
+ */
+uint16 CRC_16(const uint8 *data, uint8 length)
+{
+	uint16 crc = 0xFFFF;
+	uint8 i;
+	uint8 bit;
+
+	for(i=0 ; i<length ; ++i)
+	{
+		crc ^= (uint16)data[i] << 8;
+		for(bit=0 ; bit<8 ; ++bit)
+		{
+			crc = (crc & 0x8000) ? ((crc << 1) ^ CRC16_POLY) : (crc << 1);
+		}
+	}
+	return crc;
+}
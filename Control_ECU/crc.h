@@ -0,0 +1,35 @@
+/******************************************************************************************************
+File Name	: crc.h
+Author		: Sherif Beshr
+Description : Header file for the CRC functions of the records saved in the EEPROMs
+*******************************************************************************************************/
+
+#ifndef CRC_H_
+#define CRC_H_
+
+#include "std_types.h"
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+#define CRC8_POLY				0x07		/* CRC-8, initial value 0x00 */
+#define CRC16_POLY				0x1021		/* CRC-16/CCITT, initial value 0xFFFF */
+
+/***************************************************************************************************
+ *                                		Function Prototypes                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Returns the CRC-8 ( polynomial 0x07, initial value 0x00 ) of length bytes.
+ */
+uint8 CRC_8(const uint8 *data, uint8 length);
+
+/*
+ * Description :
+ * Returns the CRC-16/CCITT ( polynomial 0x1021, initial value 0xFFFF ) of length bytes.
+ */
+uint16 CRC_16(const uint8 *data, uint8 length);
+
+#endif /* CRC_H_ */
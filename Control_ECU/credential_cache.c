@@ -0,0 +1,122 @@
+/******************************************************************************************************
+File Name	: credential_cache.c
+Author		: Sherif Beshr
+Description : Source file for the SRAM write-back cache of the credential store. The newest record is
+			  read once at boot, every compare is served from SRAM and a new record is appended to the
+			  store only when a byte changed.
+*******************************************************************************************************/
+
+#include "credential_cache.h"
+#include "external_eeprom.h"
+
+/***************************************************************************************************
+ *                                		Global Variables                                    	   *
+ ***************************************************************************************************/
+
+static uint8 g_cache[CACHE_REGION_SIZE];
+static uint8 g_length = 0;						/* Bytes of the region in use ( end of the writes ) */
+static volatile uint8 g_dirty = FALSE;
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Call back of the write back ( in the TWI ISR ), the region stays dirty if the record isn't written.
+ */
+static void CACHE_flushDone(uint8 result)
+{
+	if(result != SUCCESS)
+	{
+		g_dirty = TRUE;
+	}
+}
+
+/*
+ * Description :
+ * Loads the credential region from the newest record of the store. Returns FALSE if there is none
+ * ( the region is all zeros then ). The region is dirty if the cold tier of the store is behind the
+ * hot one ( a write back lost by a reset ), so the next flush writes it again.
+ */
+uint8 CACHE_init(void)
+{
+	uint8 i;
+	uint8 found;
+
+	for(i=0 ; i<CACHE_REGION_SIZE ; ++i)
+	{
+		g_cache[i] = 0;
+	}
+	g_length = 0;
+	found = STORE_init(g_cache, &g_length);
+	g_dirty = STORE_isColdBehind();
+	return found;
+}
+
+/*
+ * Description :
+ * Copies len bytes of the cached region from offset.
+ */
+void CACHE_read(uint8 offset, uint8 *data, uint8 len)
+{
+	uint8 i;
+
+	for(i=0 ; (i < len) && ((offset + i) < CACHE_REGION_SIZE) ; ++i)
+	{
+		data[i] = g_cache[offset + i];
+	}
+}
+
+/*
+ * Description :
+ * Writes len bytes in the cached region from offset, the region is dirty only if a byte changes.
+ */
+void CACHE_write(uint8 offset, const uint8 *data, uint8 len)
+{
+	uint8 i;
+
+	for(i=0 ; (i < len) && ((offset + i) < CACHE_REGION_SIZE) ; ++i)
+	{
+		if(g_cache[offset + i] != data[i])
+		{
+			g_cache[offset + i] = data[i];
+			g_dirty = TRUE;
+		}
+	}
+	if((offset + i) > g_length)
+	{
+		g_length = offset + i;
+		g_dirty = TRUE;
+	}
+}
+
+/*
+ * Description :
+ * Starts appending the dirty region to the store in the background ( TWI ISR ).
+ * Returns SUCCESS if nothing is dirty or the write started, ERROR otherwise ( the region stays dirty ).
+ */
+uint8 CACHE_flush(void)
+{
+	if(!g_dirty)
+	{
+		return SUCCESS;
+	}
+	/* The store copies the region in its record, the cache can change again right after */
+	g_dirty = FALSE;
+	if(STORE_append(g_cache, g_length, CACHE_flushDone) != SUCCESS)
+	{
+		g_dirty = TRUE;
+		return ERROR;
+	}
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * Returns TRUE if the cached region isn't written back to the EEPROM yet.
+ */
+uint8 CACHE_isDirty(void)
+{
+	return g_dirty;
+}
@@ -0,0 +1,57 @@
+/******************************************************************************************************
+File Name	: credential_cache.h
+Author		: Sherif Beshr
+Description : Header file for the SRAM write-back cache of the credential store
+*******************************************************************************************************/
+
+#ifndef CREDENTIAL_CACHE_H_
+#define CREDENTIAL_CACHE_H_
+
+#include "std_types.h"
+#include "credential_store.h"
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+/* Credential region: the data of the newest record of the credential store */
+#define CACHE_REGION_SIZE		STORE_DATA_SIZE
+
+/***************************************************************************************************
+ *                                		Function Prototypes                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Loads the credential region from the newest record of the store. Returns FALSE if there is none
+ * ( the region is all zeros then ). The region is dirty if the cold tier of the store is behind the
+ * hot one ( a write back lost by a reset ), so the next flush writes it again.
+ */
+uint8 CACHE_init(void);
+
+/*
+ * Description :
+ * Copies len bytes of the cached region from offset.
+ */
+void CACHE_read(uint8 offset, uint8 *data, uint8 len);
+
+/*
+ * Description :
+ * Writes len bytes in the cached region from offset, the region is dirty only if a byte changes.
+ */
+void CACHE_write(uint8 offset, const uint8 *data, uint8 len);
+
+/*
+ * Description :
+ * Starts appending the dirty region to the store in the background ( TWI ISR ).
+ * Returns SUCCESS if nothing is dirty or the write started, ERROR otherwise ( the region stays dirty ).
+ */
+uint8 CACHE_flush(void);
+
+/*
+ * Description :
+ * Returns TRUE if the cached region isn't written back to the EEPROM yet.
+ */
+uint8 CACHE_isDirty(void);
+
+#endif /* CREDENTIAL_CACHE_H_ */
@@ -0,0 +1,227 @@
+/******************************************************************************************************
+File Name	: credential_store.c
+Author		: Sherif Beshr
+Description : Source file for the tiered credential store:
+			  - hot tier : the newest record in the internal EEPROM, read at boot with one read of its
+			               cold slot only
+			  - cold tier: log in the External EEPROM, records appended in a ring of slots ( page aligned
+			               writes, no byte is rewritten until the ring wraps ), scanned at boot only
+			               if the hot record isn't valid
+			  Every append is written through to both tiers, the hot one first. A cold tier write lost by
+			  a reset is found at boot ( the slot of the hot record doesn't hold it ) and written again
+			  by the next append.
+*******************************************************************************************************/
+
+#include "credential_store.h"
+#include "external_eeprom.h"
+#include "crc.h"
+#include <avr/eeprom.h>
+
+#if ((STORE_SLOT_SIZE % EEPROM_PAGE_SIZE) != 0)
+#error "Slots must start on an EEPROM page"
+#endif
+#if (STORE_SLOT_SIZE < (STORE_DATA_SIZE + 6))
+#error "A record doesn't fit in a slot"
+#endif
+#if ((STORE_SLOTS & (STORE_SLOTS - 1)) != 0)
+#error "The slot of a record is its sequence number modulo STORE_SLOTS, it must be a power of 2"
+#endif
+
+/***************************************************************************************************
+ *                                		Global Variables                                    	   *
+ ***************************************************************************************************/
+
+static STORE_Record g_record;					/* Record being appended, read by the TWI ISR */
+static uint16 g_nextSequence = 0;				/* Written in slot g_nextSequence % STORE_SLOTS */
+static volatile uint8 g_coldBehind = FALSE;		/* The hot record isn't in the cold tier */
+
+/* Hot tier in the internal EEPROM */
+static STORE_Record EEMEM g_hotRecord;
+static uint8 EEMEM g_hotFailCount[2];			/* Count and its complement */
+static void (*g_callBackPtr)(uint8) = NULL_PTR;
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Returns TRUE if the record has the current layout and a correct CRC.
+ */
+static uint8 STORE_isValid(const STORE_Record *record)
+{
+	return (record->Magic == STORE_MAGIC) && (record->Version == STORE_VERSION) &&
+			(record->Length <= STORE_DATA_SIZE) &&
+			(record->Crc == CRC_8((const uint8 *)record, sizeof(STORE_Record) - 1));
+}
+
+/*
+ * Description :
+ * Copies the data and length of a record.
+ */
+static void STORE_copyData(const STORE_Record *record, uint8 *data, uint8 *length)
+{
+	uint8 i;
+
+	*length = record->Length;
+	for(i=0 ; i<record->Length ; ++i)
+	{
+		data[i] = record->Data[i];
+	}
+}
+
+/*
+ * Description :
+ * Call back of the cold tier write ( in the TWI ISR ): the slot is used only if the record is written,
+ * otherwise the next append writes the same slot again.
+ */
+static void STORE_appendDone(uint8 result)
+{
+	if(result == SUCCESS)
+	{
+		++g_nextSequence;
+		g_coldBehind = FALSE;
+	}
+	if(g_callBackPtr != NULL_PTR)
+	{
+		(*g_callBackPtr)(result);
+	}
+}
+
+/*
+ * Description :
+ * Loads the newest valid record: from the hot tier, or if it isn't valid by one scan of the cold tier
+ * ( one sequential read per slot ) and the hot tier is restored from it. Copies its data and length.
+ * A valid hot record is looked for in its cold slot ( one read ): if it isn't there the cold tier is
+ * behind, STORE_isColdBehind returns TRUE and the next append writes that slot again.
+ * Returns TRUE if a valid record was found, otherwise data and length are left unchanged.
+ */
+uint8 STORE_init(uint8 *data, uint8 *length)
+{
+	STORE_Record cold;
+	uint8 found = FALSE;
+	uint8 slot;
+
+	g_coldBehind = FALSE;
+	eeprom_read_block(&g_record, &g_hotRecord, sizeof(STORE_Record));
+	if(STORE_isValid(&g_record))
+	{
+		g_nextSequence = g_record.Sequence + 1;
+		STORE_copyData(&g_record, data, length);
+
+		/* The cold write of the last append ended by a reset or failed ( an unreadable slot counts as
+		 * behind, writing it again is harmless ) */
+		if((EEPROM_readBlock(STORE_LOG_ADDRESS + (uint16)(g_record.Sequence % STORE_SLOTS) * STORE_SLOT_SIZE,
+				(uint8 *)&cold, sizeof(STORE_Record)) != SUCCESS) || !STORE_isValid(&cold) ||
+				(cold.Sequence != g_record.Sequence))
+		{
+			g_nextSequence = g_record.Sequence;
+			g_coldBehind = TRUE;
+		}
+		return TRUE;
+	}
+
+	g_nextSequence = 0;
+	for(slot=0 ; slot<STORE_SLOTS ; ++slot)
+	{
+		if((EEPROM_readBlock(STORE_LOG_ADDRESS + (uint16)slot * STORE_SLOT_SIZE, (uint8 *)&g_record,
+				sizeof(STORE_Record)) != SUCCESS) || !STORE_isValid(&g_record))
+		{
+			continue;									/* Erased, torn, other layout or unreadable slot */
+		}
+		/* Newer if ahead of the newest one so far ( sequence numbers wrap around ) */
+		if(!found || ((sint16)(g_record.Sequence - (g_nextSequence - 1)) > 0))
+		{
+			found = TRUE;
+			g_nextSequence = g_record.Sequence + 1;
+			STORE_copyData(&g_record, data, length);
+		}
+	}
+
+	if(found)
+	{
+		/* Restores the hot tier from the newest cold record */
+		slot = (uint8)((g_nextSequence - 1) % STORE_SLOTS);
+		if(EEPROM_readBlock(STORE_LOG_ADDRESS + (uint16)slot * STORE_SLOT_SIZE, (uint8 *)&g_record,
+				sizeof(STORE_Record)) == SUCCESS)
+		{
+			eeprom_update_block(&g_record, &g_hotRecord, sizeof(STORE_Record));
+		}
+	}
+	return found;
+}
+
+/*
+ * Description :
+ * Appends a record with length bytes of data ( up to STORE_DATA_SIZE ): written in the hot tier before
+ * returning ( only the bytes that change ), then in the next slot of the cold tier in the background
+ * ( TWI ISR ). The call back gets the result of the cold tier write. Returns ERROR if it couldn't start.
+ * Waits for the previous append first, STORE_APPEND_WAIT_MS at most.
+ */
+uint8 STORE_append(const uint8 *data, uint8 length, void(*a_ptr)(uint8))
+{
+	uint8 i;
+
+	/* The record buffer is read by the TWI ISR until the previous append ends ( EEPROM_isPending runs the
+	 * bus deadline, STORE_APPEND_WAIT_MS at most ) */
+	while(EEPROM_isPending());
+
+	if(length > STORE_DATA_SIZE)
+	{
+		return ERROR;
+	}
+	g_record.Magic = STORE_MAGIC;
+	g_record.Version = STORE_VERSION;
+	g_record.Sequence = g_nextSequence;
+	g_record.Length = length;
+	for(i=0 ; i<STORE_DATA_SIZE ; ++i)
+	{
+		g_record.Data[i] = (i < length) ? data[i] : 0;
+	}
+	g_record.Crc = CRC_8((const uint8 *)&g_record, sizeof(STORE_Record) - 1);
+	eeprom_update_block(&g_record, &g_hotRecord, sizeof(STORE_Record));
+
+	g_callBackPtr = a_ptr;
+	return EEPROM_writeAsync(STORE_LOG_ADDRESS + (uint16)(g_nextSequence % STORE_SLOTS) * STORE_SLOT_SIZE,
+			(const uint8 *)&g_record, sizeof(STORE_Record), STORE_appendDone);
+}
+
+/*
+ * Description :
+ * Returns TRUE if the cold tier doesn't hold the hot record ( found by STORE_init ) until an append
+ * writes it.
+ */
+uint8 STORE_isColdBehind(void)
+{
+	return g_coldBehind;
+}
+
+/*
+ * Description :
+ * Loads the fail counter from the hot tier. Returns FALSE if it was never saved or is corrupted.
+ */
+uint8 STORE_loadFailCount(uint8 *count)
+{
+	uint8 saved[2];
+
+	eeprom_read_block(saved, g_hotFailCount, 2);
+	if((uint8)(saved[0] ^ saved[1]) != 0xFF)
+	{
+		return FALSE;
+	}
+	*count = saved[0];
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Saves the fail counter in the hot tier only ( nothing is written if it didn't change ).
+ */
+void STORE_saveFailCount(uint8 count)
+{
+	uint8 saved[2];
+
+	saved[0] = count;
+	saved[1] = (uint8)(~count);
+	eeprom_update_block(saved, g_hotFailCount, 2);
+}
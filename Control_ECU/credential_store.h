@@ -0,0 +1,94 @@
+/******************************************************************************************************
+File Name	: credential_store.h
+Author		: Sherif Beshr
+Description : Header file for the tiered credential store: hot tier in the internal EEPROM, cold tier
+			  log structured in the External EEPROM
+*******************************************************************************************************/
+
+#ifndef CREDENTIAL_STORE_H_
+#define CREDENTIAL_STORE_H_
+
+#include "std_types.h"
+#include "external_eeprom.h"
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+/* Cold tier: ring of record slots in the first 1 KB of the 24C16, every change is appended to the next
+ * slot so the writes are spread evenly on the slots. A slot is 2 pages, a record is written in 2 page
+ * writes. The hot tier is one record in the internal EEPROM */
+#define STORE_LOG_ADDRESS		0x0000
+#define STORE_SLOT_SIZE			32
+#define STORE_SLOTS				32
+#define STORE_DATA_SIZE			16
+#define STORE_MAGIC				0xC5		/* First byte of every record, an erased slot reads 0xFF */
+#define STORE_VERSION			2			/* Record layout version, records of another layout are ignored */
+
+/* Longest wait of STORE_append for the cold tier write of the previous record ( every page of the slot ) */
+#define STORE_APPEND_WAIT_MS	((STORE_SLOT_SIZE / EEPROM_PAGE_SIZE) * EEPROM_ASYNC_PAGE_TIMEOUT_MS)
+
+/***************************************************************************************************
+ *                                		Types Decelerations                                  	   *
+ ***************************************************************************************************/
+
+/*	Record of the log, the layout of every credential in the EEPROM:
+ * 	1- STORE_MAGIC
+ * 	2- STORE_VERSION
+ * 	3- Sequence number, the valid record with the highest one is the current data ( wraps around )
+ * 	4- Number of data bytes used ( salt and digest of the password for the Control ECU )
+ * 	5- Data
+ * 	6- CRC-8 ( polynomial 0x07 ) of the fields above, a record torn by a reset is ignored
+ */
+typedef struct
+{
+	uint8	Magic;
+	uint8	Version;
+	uint16	Sequence;
+	uint8	Length;
+	uint8	Data[STORE_DATA_SIZE];
+	uint8	Crc;
+}STORE_Record;
+
+/***************************************************************************************************
+ *                                		Function Prototypes                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Loads the newest valid record from the hot tier, or by one scan of the cold tier if the hot one isn't
+ * valid. Copies its data and length. A valid hot record is looked for in its cold slot, if it isn't
+ * there the cold tier is behind ( STORE_isColdBehind ) and the next append writes that slot again.
+ * Returns TRUE if a valid record was found, otherwise data and length are left unchanged.
+ */
+uint8 STORE_init(uint8 *data, uint8 *length);
+
+/*
+ * Description :
+ * Appends a record with length bytes of data ( up to STORE_DATA_SIZE ): written in the hot tier before
+ * returning, then in the next slot of the cold tier in the background ( TWI ISR ). The call back gets
+ * the result of the cold tier write. Returns ERROR if it couldn't start. Waits for the previous append
+ * first, STORE_APPEND_WAIT_MS at most.
+ */
+uint8 STORE_append(const uint8 *data, uint8 length, void(*a_ptr)(uint8));
+
+/*
+ * Description :
+ * Returns TRUE if the cold tier doesn't hold the hot record ( found by STORE_init ) until an append
+ * writes it.
+ */
+uint8 STORE_isColdBehind(void);
+
+/*
+ * Description :
+ * Loads the fail counter from the hot tier. Returns FALSE if it was never saved or is corrupted.
+ */
+uint8 STORE_loadFailCount(uint8 *count);
+
+/*
+ * Description :
+ * Saves the fail counter in the hot tier only ( nothing is written if it didn't change ).
+ */
+void STORE_saveFailCount(uint8 count);
+
+#endif /* CREDENTIAL_STORE_H_ */
@@ -0,0 +1,256 @@
+/******************************************************************************************************
+File Name	: digest.c
+Author		: Sherif Beshr
+Description : Source file for the salted digests of the passwords and PINs saved in the EEPROMs:
+			  SipHash-2-4 keyed by the salt and the device secret. The 64-bit state is kept as
+			  32-bit halves so the rotations by 16 and 32 bits are register moves and the rotations
+			  by 13 / 17 / 21 become byte moves and short shifts for avr-gcc.
+*******************************************************************************************************/
+
+#include "digest.h"
+#include "entropy.h"
+#include "timebase.h"
+#if (DIGEST_BENCHMARK)
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#endif
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+/* 32 bits of a half ( free on the AVR, uint32 is wider in the host builds ) */
+#define DIGEST_HALF(x)		((x) & 0xFFFFFFFFUL)
+
+#if ((ENTROPY_SIZE != DIGEST_SALT_SIZE) || (DIGEST_SIZE != DIGEST_SALT_SIZE))
+#error "DIGEST_newSalt keys the digests with the entropy seed and makes the salt from a digest"
+#endif
+
+/***************************************************************************************************
+ *                                		Types Decelerations                                  	   *
+ ***************************************************************************************************/
+
+/*	64-bit SipHash word as 32-bit halves	*/
+typedef struct
+{
+	uint32	Low;
+	uint32	High;
+}DIGEST_Word;
+
+/***************************************************************************************************
+ *                                		Global Variables                                    	   *
+ ***************************************************************************************************/
+
+static const uint8 g_secret[DIGEST_SALT_SIZE] = DIGEST_SECRET;
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * a += b ( 64-bit ).
+ */
+static void DIGEST_add(DIGEST_Word *a, const DIGEST_Word *b)
+{
+	uint32 low = DIGEST_HALF(a->Low + b->Low);
+
+	a->High = DIGEST_HALF(a->High + b->High + (low < a->Low));
+	a->Low = low;
+}
+
+/*
+ * Description :
+ * a ^= b ( 64-bit ).
+ */
+static void DIGEST_xor(DIGEST_Word *a, const DIGEST_Word *b)
+{
+	a->Low ^= b->Low;
+	a->High ^= b->High;
+}
+
+/*
+ * Description :
+ * Rotates left by bits ( 1 .. 31 ).
+ */
+static void DIGEST_rotate(DIGEST_Word *a, uint8 bits)
+{
+	uint32 low = a->Low;
+
+	a->Low = DIGEST_HALF((low << bits) | (a->High >> (32 - bits)));
+	a->High = DIGEST_HALF((a->High << bits) | (low >> (32 - bits)));
+}
+
+/*
+ * Description :
+ * Rotates left by 32 bits: swaps the halves.
+ */
+static void DIGEST_swap(DIGEST_Word *a)
+{
+	uint32 low = a->Low;
+
+	a->Low = a->High;
+	a->High = low;
+}
+
+/*
+ * Description :
+ * One SipHash round on v[0..3].
+ */
+static void DIGEST_round(DIGEST_Word *v)
+{
+	DIGEST_add(&v[0], &v[1]);	DIGEST_rotate(&v[1], 13);	DIGEST_xor(&v[1], &v[0]);	DIGEST_swap(&v[0]);
+	DIGEST_add(&v[2], &v[3]);	DIGEST_rotate(&v[3], 16);	DIGEST_xor(&v[3], &v[2]);
+	DIGEST_add(&v[0], &v[3]);	DIGEST_rotate(&v[3], 21);	DIGEST_xor(&v[3], &v[0]);
+	DIGEST_add(&v[2], &v[1]);	DIGEST_rotate(&v[1], 17);	DIGEST_xor(&v[1], &v[2]);	DIGEST_swap(&v[2]);
+}
+
+/*
+ * Description :
+ * Reads a little endian 64-bit word of 8 bytes.
+ */
+static void DIGEST_load(DIGEST_Word *word, const uint8 *bytes)
+{
+	word->Low = bytes[0] | ((uint32)bytes[1] << 8) | ((uint32)bytes[2] << 16) | ((uint32)bytes[3] << 24);
+	word->High = bytes[4] | ((uint32)bytes[5] << 8) | ((uint32)bytes[6] << 16) | ((uint32)bytes[7] << 24);
+}
+
+/*
+ * Description :
+ * Absorbs one message word: v3 ^= m, 2 rounds, v0 ^= m.
+ */
+static void DIGEST_compress(DIGEST_Word *v, const DIGEST_Word *m)
+{
+	DIGEST_xor(&v[3], m);
+	DIGEST_round(v);
+	DIGEST_round(v);
+	DIGEST_xor(&v[0], m);
+}
+
+/*
+ * Description :
+ * Computes the DIGEST_SIZE bytes digest of length bytes of data with the salt ( DIGEST_SALT_SIZE bytes ):
+ * SipHash-2-4 with the key salt | device secret, the digest is little endian.
+ */
+void DIGEST_compute(const uint8 *salt, const uint8 *data, uint8 length, uint8 *digest)
+{
+	DIGEST_Word v[4];
+	DIGEST_Word k0;
+	DIGEST_Word k1;
+	DIGEST_Word m;
+	uint8 last[8] = {0};
+	uint8 i;
+
+	DIGEST_load(&k0, salt);
+	DIGEST_load(&k1, g_secret);
+	v[0].Low = k0.Low ^ 0x70736575UL;	v[0].High = k0.High ^ 0x736f6d65UL;
+	v[1].Low = k1.Low ^ 0x6e646f6dUL;	v[1].High = k1.High ^ 0x646f7261UL;
+	v[2].Low = k0.Low ^ 0x6e657261UL;	v[2].High = k0.High ^ 0x6c796765UL;
+	v[3].Low = k1.Low ^ 0x79746573UL;	v[3].High = k1.High ^ 0x74656462UL;
+
+	for(i=0 ; (i + 8) <= length ; i += 8)
+	{
+		DIGEST_load(&m, &data[i]);
+		DIGEST_compress(v, &m);
+	}
+	/* Last word: the remaining bytes and the length in the top byte */
+	for( ; i<length ; ++i)
+	{
+		last[i & 7] = data[i];
+	}
+	last[7] = length;
+	DIGEST_load(&m, last);
+	DIGEST_compress(v, &m);
+
+	v[2].Low ^= 0xFF;
+	for(i=0 ; i<4 ; ++i)
+	{
+		DIGEST_round(v);
+	}
+	DIGEST_xor(&v[0], &v[1]);
+	DIGEST_xor(&v[0], &v[2]);
+	DIGEST_xor(&v[0], &v[3]);
+	for(i=0 ; i<4 ; ++i)
+	{
+		digest[i] = (uint8)(v[0].Low >> (8 * i));
+		digest[i + 4] = (uint8)(v[0].High >> (8 * i));
+	}
+}
+
+/*
+ * Description :
+ * Returns TRUE if both digests are equal. All the bytes are compared whatever the first one that differs
+ * so the time doesn't tell how many bytes of a guess are right.
+ */
+uint8 DIGEST_equal(const uint8 *digest1, const uint8 *digest2)
+{
+	uint8 difference = 0;
+	uint8 i;
+
+	for(i=0 ; i<DIGEST_SIZE ; ++i)
+	{
+		difference |= digest1[i] ^ digest2[i];
+	}
+	return (difference == 0);
+}
+
+/*
+ * Description :
+ * Makes a new salt ( DIGEST_SALT_SIZE bytes ): the digest of the time of the call ( the user decides it
+ * to the millisecond ) keyed by the entropy seed ( ADC noise and the seed of the previous salt, kept in
+ * the internal EEPROM ). The next seed is a second digest so the salt saved in clear doesn't give it away.
+ */
+void DIGEST_newSalt(uint8 *salt)
+{
+	uint32 now = Timebase_getMs();
+	uint8 key[ENTROPY_SIZE];
+	uint8 seed[5];
+	uint8 i;
+
+	for(i=0 ; i<4 ; ++i)
+	{
+		seed[i] = (uint8)(now >> (8 * i));
+	}
+	ENTROPY_get(key);
+	seed[4] = 0;
+	DIGEST_compute(key, seed, 5, salt);
+	seed[4] = 1;
+	DIGEST_compute(key, seed, 5, key);
+	ENTROPY_save(key);
+}
+
+#if (DIGEST_BENCHMARK)
+/*
+ * Description :
+ * Measures on Timer1 ( pre-scalar 8, 8 cycles resolution ) the CPU cycles of the digest of a length
+ * digits PIN and of a whole verification ( digest and compare ). Interrupts are disabled while measuring.
+ */
+void DIGEST_benchmark(uint8 length, uint32 *hash_cycles, uint32 *verify_cycles)
+{
+	uint8 pin[16] = "12345678901234";
+	uint8 salt[DIGEST_SALT_SIZE] = {0};
+	uint8 saved[DIGEST_SIZE] = {0};
+	uint8 digest[DIGEST_SIZE];
+	uint8 sreg = SREG;
+	uint16 counts;
+
+	length = (length > 14) ? 14 : length;
+	cli();
+	TCCR1A = 0;
+	TCCR1B = (1<<CS11);
+
+	TCNT1 = 0;
+	DIGEST_compute(salt, pin, length, digest);
+	counts = TCNT1;
+	*hash_cycles = (uint32)counts * 8;
+
+	TCNT1 = 0;
+	DIGEST_compute(salt, pin, length, digest);
+	(void)DIGEST_equal(digest, saved);
+	counts = TCNT1;
+	*verify_cycles = (uint32)counts * 8;
+
+	TCCR1B = 0;
+	SREG = sreg;
+}
+#endif
@@ -0,0 +1,63 @@
+/******************************************************************************************************
+File Name	: digest.h
+Author		: Sherif Beshr
+Description : Header file for the salted digests of the passwords and PINs saved in the EEPROMs
+*******************************************************************************************************/
+
+#ifndef DIGEST_H_
+#define DIGEST_H_
+
+#include "std_types.h"
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+#define DIGEST_SIZE				8			/* SipHash-2-4 output */
+#define DIGEST_SALT_SIZE		8
+
+/* Device secret, second half of the SipHash key ( the salt is the first one ). It must be set per build
+ * with -DDIGEST_SECRET="{ ... }" ( 8 random bytes, never committed ): the default below is public, with it
+ * a dump of the EEPROM alone can be brute forced off the device */
+#ifndef DIGEST_SECRET
+#define DIGEST_SECRET			{ 0x3B, 0xA7, 0x5C, 0x91, 0x0E, 0xD2, 0x68, 0xF4 }
+#endif
+
+/* 1: DIGEST_benchmark measures the hash and the verification in CPU cycles on Timer1 */
+#ifndef DIGEST_BENCHMARK
+#define DIGEST_BENCHMARK		0
+#endif
+
+/***************************************************************************************************
+ *                                		Function Prototypes                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Computes the DIGEST_SIZE bytes digest of length bytes of data with the salt ( DIGEST_SALT_SIZE bytes ).
+ */
+void DIGEST_compute(const uint8 *salt, const uint8 *data, uint8 length, uint8 *digest);
+
+/*
+ * Description :
+ * Returns TRUE if both digests are equal, in the same time whatever the bytes that differ.
+ */
+uint8 DIGEST_equal(const uint8 *digest1, const uint8 *digest2);
+
+/*
+ * Description :
+ * Makes a new salt ( DIGEST_SALT_SIZE bytes ) from the time of the call, ADC noise and a seed kept in the
+ * internal EEPROM from the previous salts ( different on every device and after every reset ).
+ */
+void DIGEST_newSalt(uint8 *salt);
+
+#if (DIGEST_BENCHMARK)
+/*
+ * Description :
+ * Measures on Timer1 ( 8 cycles resolution ) the CPU cycles of the digest of a length digits PIN and of
+ * a whole verification ( digest and compare ). Uses Timer1, interrupts are disabled while measuring.
+ */
+void DIGEST_benchmark(uint8 length, uint32 *hash_cycles, uint32 *verify_cycles);
+#endif
+
+#endif /* DIGEST_H_ */
@@ -0,0 +1,64 @@
+/******************************************************************************************************
+File Name	: entropy.c
+Author		: Sherif Beshr
+Description : Source file for the seed of the salts: noise of the ADC and a seed kept in the internal
+			  EEPROM across resets
+*******************************************************************************************************/
+
+#include "entropy.h"
+#include "common_macros.h"
+#include <avr/io.h>				/* To use the ADC Registers */
+#include <avr/eeprom.h>			/* Seed of the next boot */
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+#define ENTROPY_ADC_BANDGAP		0x1E		/* MUX4:0 of the 1.22 V bandgap */
+
+/***************************************************************************************************
+ *                                		Global Variables                                    	   *
+ ***************************************************************************************************/
+
+static uint8 EEMEM g_hotSeed[ENTROPY_SIZE];		/* Erased ( 0xFF ) on a new device */
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Fills ENTROPY_SIZE bytes with the seed saved by ENTROPY_save mixed with the lowest bits of
+ * ENTROPY_SAMPLES conversions of the ADC bandgap channel. The ADC clock is F_CPU / 4, far above the
+ * 200 kHz of a full resolution conversion, so the lowest bits are noise. The ADC is off again after.
+ */
+void ENTROPY_get(uint8 *seed)
+{
+	uint8 i;
+
+	eeprom_read_block(seed, g_hotSeed, ENTROPY_SIZE);
+
+	/* AVCC reference, bandgap channel, ADC enabled with pre-scalar 4 */
+	ADMUX = (1<<REFS0) | ENTROPY_ADC_BANDGAP;
+	ADCSRA = (1<<ADEN) | (1<<ADPS1);
+	for(i=0 ; i<ENTROPY_SAMPLES ; ++i)
+	{
+		SET_BIT(ADCSRA,ADSC);
+		while(BIT_IS_SET(ADCSRA,ADSC));
+		/* Rotate the byte then fold in the 2 lowest bits and the time base count ( ADCL must be read
+		 * before ADCH ) */
+		seed[i % ENTROPY_SIZE] = (uint8)((seed[i % ENTROPY_SIZE] << 2) | (seed[i % ENTROPY_SIZE] >> 6)) ^
+				(ADCL & 0x03) ^ TCNT0;
+		(void)ADCH;
+	}
+	ADCSRA = 0;
+}
+
+/*
+ * Description :
+ * Saves the seed of the next ENTROPY_get in the internal EEPROM ( only the changed bytes are written ).
+ */
+void ENTROPY_save(const uint8 *seed)
+{
+	eeprom_update_block(seed, g_hotSeed, ENTROPY_SIZE);
+}
@@ -0,0 +1,37 @@
+/******************************************************************************************************
+File Name	: entropy.h
+Author		: Sherif Beshr
+Description : Header file for the seed of the salts: noise of the ADC and a seed kept in the internal
+			  EEPROM across resets
+*******************************************************************************************************/
+
+#ifndef ENTROPY_H_
+#define ENTROPY_H_
+
+#include "std_types.h"
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+#define ENTROPY_SIZE			8			/* Bytes of a seed */
+#define ENTROPY_SAMPLES			64			/* ADC conversions folded in a seed ( 8 per byte ) */
+
+/***************************************************************************************************
+ *                                		Function Prototypes                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Fills ENTROPY_SIZE bytes with the seed saved by ENTROPY_save mixed with the lowest bits of
+ * ENTROPY_SAMPLES fast conversions of the ADC bandgap channel ( no pin is used ).
+ */
+void ENTROPY_get(uint8 *seed);
+
+/*
+ * Description :
+ * Saves the seed of the next ENTROPY_get in the internal EEPROM so it differs after every reset.
+ */
+void ENTROPY_save(const uint8 *seed);
+
+#endif /* ENTROPY_H_ */
@@ -6,13 +6,89 @@ Description : Source file for the External EEPROM Memory
 
 #include "external_eeprom.h"
 #include "twi.h"
+#include "timebase.h"
+
+/***************************************************************************************************
+ *                                		Global Variables                                    	   *
+ ***************************************************************************************************/
+
+/* Asynchronous read / write: one at a time, run by the TWI ISR */
+static TWI_Transaction g_transaction;
+static volatile uint8 g_pending = FALSE;
+static uint16 g_address;						/* Address of the page being written */
+static const uint8 *g_data;						/* Data of the page being written */
+static uint16 g_remaining;						/* Bytes left to write from g_address */
+static uint32 g_pollStart;						/* Start of the acknowledge polling */
+static uint32 g_pollLast;						/* Time of the last address NACK */
+static volatile uint8 g_pollDue = FALSE;		/* Page waits for the next acknowledge poll ( EEPROM_isPending ) */
+static uint8 g_attempts;						/* Attempts of the running transaction failed by the bus */
+static void (*g_callBackPtr)(uint8) = NULL_PTR;
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
 
 /*
  * Description :
- * Function to write a byte on EEPROM from Address xx.
+ * Function to check if the EEPROM finished its internal write cycle (acknowledge polling): the EEPROM
+ * doesn't acknowledge its address while it writes. One short transaction, so callers can overlap other
+ * work with the write cycle.
  */
-uint8 EEPROM_writeByte(uint16 u16addr,uint8 u8data)
+uint8 EEPROM_isBusy(void)
+{
+	uint8 busy;
+
+	/* The bus belongs to the asynchronous transactions */
+	if(TWI_isBusy())
+		return TRUE;
+
+	/* Send the Start Bit */
+	TWI_start();
+	if(TWI_getStatus() != TWI_START)
+	{
+		TWI_stop();
+		return TRUE;
+	}
+	/* Send the device address with R/W=0 (write), an ACK means the write cycle ended */
+	TWI_writeByte(0xA0);
+	busy = (TWI_getStatus() != TWI_MT_SLA_W_ACK);
+	/* Send the Stop Bit */
+	TWI_stop();
+
+	return busy;
+}
+
+/*
+ * Description :
+ * Function to wait until the EEPROM acknowledges again, instead of a fixed worst case delay after each
+ * write. Returns ERROR if it is still busy after EEPROM_READY_TIMEOUT_MS.
+ */
+static uint8 EEPROM_waitReady(void)
+{
+	uint32 start;
+
+	/* Asynchronous transactions end on their own deadlines ( TWI_TIMEOUT_MS without a bus event ) */
+	while(TWI_isBusy());
+
+	start = Timebase_getMs();
+	while(EEPROM_isBusy())
+	{
+		if((Timebase_getMs() - start) >= EEPROM_READY_TIMEOUT_MS)
+			return ERROR;
+	}
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * One attempt to write a byte on EEPROM from Address xx, the caller sends the stop if it fails.
+ */
+static uint8 EEPROM_writeByteOnce(uint16 u16addr,uint8 u8data)
 {
+	/* Wait for the write cycle of the previous write */
+	if(EEPROM_waitReady() != SUCCESS)
+		return ERROR;
+
 	/* Send the Start Bit */
 	TWI_start();
 	if(TWI_getStatus() != TWI_START)
@@ -41,10 +117,14 @@ uint8 EEPROM_writeByte(uint16 u16addr,uint8 u8data)
 
 /*
  * Description :
- * Function to read a byte from EEPROM from Address xx.
+ * One attempt to read a byte from EEPROM from Address xx, the caller sends the stop if it fails.
  */
-uint8 EEPROM_readByte(uint16 u16addr,uint8 *u8data)
+static uint8 EEPROM_readByteOnce(uint16 u16addr,uint8 *u8data)
 {
+	/* Wait for the write cycle of the previous write */
+	if(EEPROM_waitReady() != SUCCESS)
+		return ERROR;
+
 	/* Send the Start Bit */
 	TWI_start();
 	if(TWI_getStatus() != TWI_START)
@@ -81,3 +161,361 @@ uint8 EEPROM_readByte(uint16 u16addr,uint8 *u8data)
 
     return SUCCESS;
 }
+
+/*
+ * Description :
+ * One attempt to write count bytes of one page on EEPROM from Address xx, the caller sends the stop if
+ * it fails. The stop of a written page starts its internal write cycle (polled by the next access).
+ */
+static uint8 EEPROM_writePageOnce(uint16 u16addr, const uint8 *u8data, uint16 count)
+{
+	/* Wait for the write cycle of the previous page */
+	if(EEPROM_waitReady() != SUCCESS)
+		return ERROR;
+
+	/* Send the Start Bit */
+	TWI_start();
+	if(TWI_getStatus() != TWI_START)
+		return ERROR;
+	/* Send the device address, we need to get A8 A9 A10 address bits from the
+	 * memory location address and R/W=0 (write) */
+	TWI_writeByte((uint8)(0xA0 | ((u16addr & 0x0700)>>7)));
+	if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
+		return ERROR;
+
+	/* Send the required memory location address */
+	TWI_writeByte((uint8)(u16addr));
+	if (TWI_getStatus() != TWI_MT_DATA_ACK)
+		return ERROR;
+
+	/* Fill the page buffer, the EEPROM increments the address inside the page */
+	while(count > 0)
+	{
+		TWI_writeByte(*u8data);
+		if (TWI_getStatus() != TWI_MT_DATA_ACK)
+			return ERROR;
+		++u8data;
+		--count;
+	}
+
+	/* Send the Stop Bit */
+	TWI_stop();
+
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * One attempt to read len bytes from EEPROM from Address xx, the caller sends the stop if it fails.
+ * The address is sent once, then the bytes are streamed with ACK (the EEPROM increments its address
+ * counter) and the last one with NACK.
+ */
+static uint8 EEPROM_readBlockOnce(uint16 u16addr, uint8 *u8data, uint16 len)
+{
+	/* Wait for the write cycle of the previous write */
+	if(EEPROM_waitReady() != SUCCESS)
+		return ERROR;
+
+	/* Send the Start Bit */
+	TWI_start();
+	if(TWI_getStatus() != TWI_START)
+		return ERROR;
+    /* Send the device address, we need to get A8 A9 A10 address bits from the
+     * memory location address and R/W=0 (write) */
+    TWI_writeByte((uint8)(0xA0 | ((u16addr & 0x0700)>>7)));
+    if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
+        return ERROR;
+
+    /* Send the required memory location address */
+    TWI_writeByte((uint8)(u16addr));
+    if (TWI_getStatus() != TWI_MT_DATA_ACK)
+        return ERROR;
+
+    /* Send the Repeated Start Bit */
+    TWI_start();
+    if (TWI_getStatus() != TWI_REP_START)
+        return ERROR;
+
+    /* Send the device address, we need to get A8 A9 A10 address bits from the
+     * memory location address and R/W=1 (Read) */
+    TWI_writeByte((uint8)((0xA0) | ((u16addr & 0x0700)>>7) | 1));
+    if (TWI_getStatus() != TWI_MT_SLA_R_ACK)
+        return ERROR;
+
+    /* Read Bytes from Memory sending ACK to get the next one */
+    while(len > 1)
+    {
+    	*u8data = TWI_readByteWithACK();
+    	if (TWI_getStatus() != TWI_MR_DATA_ACK)
+    		return ERROR;
+    	++u8data;
+    	--len;
+    }
+
+    /* Read the last Byte without send ACK */
+    *u8data = TWI_readByteWithNACK();
+    if (TWI_getStatus() != TWI_MR_DATA_NACK)
+        return ERROR;
+
+    /* Send the Stop Bit */
+    TWI_stop();
+
+    return SUCCESS;
+}
+
+/*
+ * Description :
+ * Function to write a byte on EEPROM from Address xx. An attempt failed by the bus ( timeout, bus error,
+ * NACK ) is ended with a stop and done again, EEPROM_RETRIES attempts at most.
+ */
+uint8 EEPROM_writeByte(uint16 u16addr,uint8 u8data)
+{
+	uint8 attempt;
+
+	for(attempt=0 ; attempt<EEPROM_RETRIES ; ++attempt)
+	{
+		if(EEPROM_writeByteOnce(u16addr, u8data) == SUCCESS)
+			return SUCCESS;
+		TWI_stop();
+	}
+	return ERROR;
+}
+
+/*
+ * Description :
+ * Function to read a byte from EEPROM from Address xx. An attempt failed by the bus ( timeout, bus error,
+ * NACK ) is ended with a stop and done again, EEPROM_RETRIES attempts at most.
+ */
+uint8 EEPROM_readByte(uint16 u16addr,uint8 *u8data)
+{
+	uint8 attempt;
+
+	for(attempt=0 ; attempt<EEPROM_RETRIES ; ++attempt)
+	{
+		if(EEPROM_readByteOnce(u16addr, u8data) == SUCCESS)
+			return SUCCESS;
+		TWI_stop();
+	}
+	return ERROR;
+}
+
+/*
+ * Description :
+ * Function to write len bytes on EEPROM from Address xx. The bytes are split on the page boundaries,
+ * each page is sent in one transaction to the page buffer of the EEPROM, so the internal write cycle
+ * is waited once for the whole page instead of once per byte. A page failed by the bus is ended with a
+ * stop and sent again, EEPROM_RETRIES attempts at most.
+ */
+uint8 EEPROM_writePage(uint16 u16addr, const uint8 *u8data, uint16 len)
+{
+	uint16 count;
+	uint8 attempt;
+
+	while(len > 0)
+	{
+		/* Bytes left until the end of the page of this address */
+		count = EEPROM_PAGE_SIZE - (u16addr & (EEPROM_PAGE_SIZE - 1));
+		if(count > len)
+		{
+			count = len;
+		}
+
+		for(attempt=0 ; EEPROM_writePageOnce(u16addr, u8data, count) != SUCCESS ; ++attempt)
+		{
+			TWI_stop();
+			if((attempt + 1) >= EEPROM_RETRIES)
+				return ERROR;
+		}
+		u16addr += count;
+		u8data += count;
+		len -= count;
+	}
+
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * Function to read len bytes from EEPROM from Address xx in one sequential read. An attempt failed by the
+ * bus ( timeout, bus error, NACK ) is ended with a stop and done again, EEPROM_RETRIES attempts at most.
+ */
+uint8 EEPROM_readBlock(uint16 u16addr, uint8 *u8data, uint16 len)
+{
+	uint8 attempt;
+
+	if(len == 0)
+		return SUCCESS;
+
+	for(attempt=0 ; attempt<EEPROM_RETRIES ; ++attempt)
+	{
+		if(EEPROM_readBlockOnce(u16addr, u8data, len) == SUCCESS)
+			return SUCCESS;
+		TWI_stop();
+	}
+	return ERROR;
+}
+
+/*
+ * Description :
+ * Prepares the transaction of the next page of an asynchronous write ( split on the page boundaries ).
+ */
+static void EEPROM_setupPage(void)
+{
+	uint16 count = EEPROM_PAGE_SIZE - (g_address & (EEPROM_PAGE_SIZE - 1));
+
+	if(count > g_remaining)
+	{
+		count = g_remaining;
+	}
+	/* Device address with A8 A9 A10 address bits, then the memory location address */
+	g_transaction.SlaveAddress = (uint8)(0xA0 | ((g_address & 0x0700)>>7));
+	g_transaction.SubAddress[0] = (uint8)(g_address);
+	g_transaction.SubAddressLength = 1;
+	g_transaction.TxData = g_data;
+	g_transaction.TxLength = count;
+	g_transaction.RxLength = 0;
+}
+
+/*
+ * Description :
+ * Ends the asynchronous read / write and calls the call back of the application.
+ */
+static void EEPROM_asyncEnd(uint8 result)
+{
+	g_pending = FALSE;
+	if(g_callBackPtr != NULL_PTR)
+	{
+		(*g_callBackPtr)(result);
+	}
+}
+
+/*
+ * Description :
+ * Call back of the TWI transactions (in the TWI ISR). An address NACK means the EEPROM is in the write
+ * cycle of the previous page, the transaction is sent again by EEPROM_isPending EEPROM_POLL_INTERVAL_MS
+ * later (acknowledge polling) until the deadline, the bus and the CPU are free in between.
+ * A transaction failed by the bus ( timeout, bus error, arbitration ) is sent again EEPROM_RETRIES times.
+ */
+static void EEPROM_transactionDone(TWI_Transaction *transaction)
+{
+	switch(transaction->Result)
+	{
+	case TWI_RESULT_ADDRESS_NACK:
+		g_pollLast = Timebase_getMs();
+		if((g_pollLast - g_pollStart) < EEPROM_READY_TIMEOUT_MS)
+		{
+			g_pollDue = TRUE;
+			return;
+		}
+		EEPROM_asyncEnd(ERROR);
+		break;
+	case TWI_RESULT_TIMEOUT:
+	case TWI_RESULT_BUS_ERROR:
+	case TWI_RESULT_ARBITRATION:
+		if((++g_attempts < EEPROM_RETRIES) && TWI_submit(transaction))
+			return;
+		EEPROM_asyncEnd(ERROR);
+		break;
+	case TWI_RESULT_OK:
+		g_pollStart = Timebase_getMs();
+		g_attempts = 0;
+		if(transaction->RxLength == 0)
+		{
+			/* Page written, the next one is polled until the write cycle ends */
+			g_address += transaction->TxLength;
+			g_data += transaction->TxLength;
+			g_remaining -= transaction->TxLength;
+			if(g_remaining > 0)
+			{
+				EEPROM_setupPage();
+				if(!TWI_submit(transaction))
+					EEPROM_asyncEnd(ERROR);
+				return;
+			}
+		}
+		EEPROM_asyncEnd(SUCCESS);
+		break;
+	default:
+		EEPROM_asyncEnd(ERROR);
+		break;
+	}
+}
+
+/*
+ * Description :
+ * Function to start writing len bytes on EEPROM from Address xx without blocking. Each page is one TWI
+ * transaction, the next page is queued from the TWI ISR when the previous one is written.
+ */
+uint8 EEPROM_writeAsync(uint16 u16addr, const uint8 *u8data, uint16 len, void(*a_ptr)(uint8))
+{
+	if(g_pending || (len == 0))
+		return ERROR;
+
+	g_pending = TRUE;
+	g_callBackPtr = a_ptr;
+	g_address = u16addr;
+	g_data = u8data;
+	g_remaining = len;
+	g_pollStart = Timebase_getMs();
+	g_pollDue = FALSE;
+	g_attempts = 0;
+	g_transaction.CallBack = EEPROM_transactionDone;
+	EEPROM_setupPage();
+	if(!TWI_submit(&g_transaction))
+	{
+		g_pending = FALSE;
+		return ERROR;
+	}
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * Function to start reading len bytes from EEPROM from Address xx without blocking, one write then
+ * read TWI transaction (sequential read).
+ */
+uint8 EEPROM_readAsync(uint16 u16addr, uint8 *u8data, uint16 len, void(*a_ptr)(uint8))
+{
+	if(g_pending || (len == 0))
+		return ERROR;
+
+	g_pending = TRUE;
+	g_callBackPtr = a_ptr;
+	g_pollStart = Timebase_getMs();
+	g_pollDue = FALSE;
+	g_attempts = 0;
+	/* Device address with A8 A9 A10 address bits, then the memory location address */
+	g_transaction.SlaveAddress = (uint8)(0xA0 | ((u16addr & 0x0700)>>7));
+	g_transaction.SubAddress[0] = (uint8)(u16addr);
+	g_transaction.SubAddressLength = 1;
+	g_transaction.TxLength = 0;
+	g_transaction.RxData = u8data;
+	g_transaction.RxLength = len;
+	g_transaction.CallBack = EEPROM_transactionDone;
+	if(!TWI_submit(&g_transaction))
+	{
+		g_pending = FALSE;
+		return ERROR;
+	}
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * Returns TRUE until the call back of the asynchronous read / write. The bus deadline is only checked by
+ * TWI_isBusy, so a transaction stuck on the bus is ended here ( retried, then ERROR to the call back ).
+ * The page waiting for the end of the write cycle is sent again every EEPROM_POLL_INTERVAL_MS.
+ */
+uint8 EEPROM_isPending(void)
+{
+	TWI_isBusy();
+	if(g_pollDue && ((Timebase_getMs() - g_pollLast) >= EEPROM_POLL_INTERVAL_MS))
+	{
+		g_pollDue = FALSE;
+		if(!TWI_submit(&g_transaction))
+		{
+			EEPROM_asyncEnd(ERROR);
+		}
+	}
+	return g_pending;
+}
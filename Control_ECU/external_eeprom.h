@@ -8,6 +8,7 @@ Description : Header file for the External EEPROM Memory
 #define EXTERNAL_EEPROM_H_
 
 #include "std_types.h"
+#include "twi.h"
 
 /***************************************************************************************************
  *                                		Macro Definitions                                   	   *
@@ -15,6 +16,23 @@ Description : Header file for the External EEPROM Memory
 #define ERROR 			0
 #define SUCCESS 		1
 
+#define EEPROM_PAGE_SIZE		16		/* 24C16 page buffer, a write can't cross a page boundary */
+#define EEPROM_WRITE_CYCLE_MS	10		/* Worst case internal write cycle (tWR) of a page */
+#define EEPROM_READY_TIMEOUT_MS	(2 * EEPROM_WRITE_CYCLE_MS)	/* Acknowledge polling gives up after it */
+#define EEPROM_RETRIES			3		/* Attempts of an access failed by the bus ( timeout, bus error ) */
+#define EEPROM_POLL_INTERVAL_MS	1		/* Spacing of the acknowledge polls of an asynchronous write */
+
+/* Bound of a blocking access that fails on every attempt: acknowledge polling, then at most one bus
+ * timeout in the polling and one in the transfer per attempt ( the bus is recovered after each ) plus
+ * 1 ms for the recovery and the bytes of a page. A successful access ends sooner. */
+#define EEPROM_ACCESS_TIMEOUT_MS	(EEPROM_RETRIES * (EEPROM_READY_TIMEOUT_MS + 2 * TWI_TIMEOUT_MS + 1))
+
+/* Bound of each page of an asynchronous read / write while EEPROM_isPending is polled ( it runs the bus
+ * deadline and the acknowledge polls ): acknowledge polling and its last interval, then EEPROM_RETRIES
+ * transfers ended by a bus timeout ( 1 ms of time base granularity each ) plus 1 ms for the bytes */
+#define EEPROM_ASYNC_PAGE_TIMEOUT_MS	(EEPROM_READY_TIMEOUT_MS + EEPROM_POLL_INTERVAL_MS + \
+										EEPROM_RETRIES * (TWI_TIMEOUT_MS + 1) + 1)
+
 
 /***************************************************************************************************
  *                                		Function Prototypes                                 	   *
@@ -23,14 +41,60 @@ Description : Header file for the External EEPROM Memory
 /*
  * Description :
  * Function to write a byte on EEPROM from Address xx.
+ * Retried EEPROM_RETRIES times, returns ERROR after EEPROM_ACCESS_TIMEOUT_MS at most.
  */
 uint8 EEPROM_writeByte(uint16 u16addr,uint8 u8data);
 
 /*
  * Description :
  * Function to read a byte from EEPROM from Address xx.
+ * Retried EEPROM_RETRIES times, returns ERROR after EEPROM_ACCESS_TIMEOUT_MS at most.
  */
 uint8 EEPROM_readByte(uint16 u16addr,uint8 *u8data);
 
+/*
+ * Description :
+ * Function to write len bytes on EEPROM from Address xx, one transaction and one write cycle per page.
+ * Retried EEPROM_RETRIES times from the failed page.
+ */
+uint8 EEPROM_writePage(uint16 u16addr, const uint8 *u8data, uint16 len);
+
+/*
+ * Description :
+ * Function to read len bytes from EEPROM from Address xx in one sequential read.
+ * Retried EEPROM_RETRIES times, returns ERROR after EEPROM_ACCESS_TIMEOUT_MS at most.
+ */
+uint8 EEPROM_readBlock(uint16 u16addr, uint8 *u8data, uint16 len);
+
+/*
+ * Description :
+ * Returns TRUE while the EEPROM is in its internal write cycle (doesn't acknowledge its address).
+ */
+uint8 EEPROM_isBusy(void);
+
+/*
+ * Description :
+ * Function to start writing len bytes on EEPROM from Address xx without blocking ( TWI ISR ), the call
+ * back gets SUCCESS or ERROR. The data must stay valid until then. Returns ERROR if one is pending.
+ * A page failed by the bus is sent again EEPROM_RETRIES times. The next page is sent when EEPROM_isPending
+ * sees the end of the write cycle ( acknowledge polls every EEPROM_POLL_INTERVAL_MS ).
+ */
+uint8 EEPROM_writeAsync(uint16 u16addr, const uint8 *u8data, uint16 len, void(*a_ptr)(uint8));
+
+/*
+ * Description :
+ * Function to start reading len bytes from EEPROM from Address xx without blocking ( TWI ISR ), the call
+ * back gets SUCCESS or ERROR. Returns ERROR if one is pending.
+ */
+uint8 EEPROM_readAsync(uint16 u16addr, uint8 *u8data, uint16 len, void(*a_ptr)(uint8));
+
+/*
+ * Description :
+ * Returns TRUE until the call back of the asynchronous read / write. Ends a transaction stuck on the bus
+ * ( TWI_isBusy ), so polling it ends after EEPROM_ASYNC_PAGE_TIMEOUT_MS per page at most. Sends the
+ * acknowledge polls of an asynchronous write during the write cycle, it must be called while waiting.
+ */
+uint8 EEPROM_isPending(void);
+
 
 #endif /* EXTERNAL_EEPROM_H_ */
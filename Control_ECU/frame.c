@@ -0,0 +1,381 @@
+/******************************************************************************************************
+File Name	: frame.c
+Author		: Sherif Beshr
+Description : Source file for the framed link protocol shared by the HMI and Control ECUs
+*******************************************************************************************************/
+
+#include "frame.h"
+#include "uart.h"
+#include "timebase.h"
+
+/***************************************************************************************************
+ *                                		Types Decelerations                                  	   *
+ ***************************************************************************************************/
+
+/*	States of the receive state machine	*/
+typedef enum
+{
+	FRAME_WAIT_START, FRAME_WAIT_TYPE, FRAME_WAIT_LENGTH, FRAME_WAIT_PAYLOAD, FRAME_WAIT_CRC
+}Frame_RxState;
+
+/***************************************************************************************************
+ *                                		Global Variables                                    	   *
+ ***************************************************************************************************/
+
+/* Receive state machine, only touched from the UART RXC ISR */
+static Frame_RxState g_rxState = FRAME_WAIT_START;
+static uint8 g_rxIndex = 0;
+static uint8 g_rxCrc = 0;
+
+/* Queue of received frames: written by the RXC ISR (head) and read by the application (tail) */
+static volatile Frame_Type g_rxFrames[FRAME_QUEUE_SIZE];
+static volatile uint8 g_rxHead = 0;
+static volatile uint8 g_rxTail = 0;
+
+/* Longest measured recovery time of FRAME_request */
+static uint16 g_maxRecoveryMs = 0;
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Adds one byte to a running CRC-8 (polynomial 0x07).
+ */
+static uint8 FRAME_crc8Update(uint8 crc, uint8 data)
+{
+	uint8 bit;
+
+	crc ^= data;
+	for(bit=0 ; bit<8 ; ++bit)
+	{
+		if(crc & 0x80)
+		{
+			crc = (crc << 1) ^ FRAME_CRC8_POLY;
+		}
+		else
+		{
+			crc <<= 1;
+		}
+	}
+	return crc;
+}
+
+/*
+ * Description :
+ * Receive state machine called from the UART RXC ISR with every received byte.
+ * The frame is built directly in the free slot at the queue head and only published when its
+ * CRC is correct and the queue has room, otherwise it is dropped.
+ */
+static void FRAME_rxByte(uint8 data)
+{
+	volatile Frame_Type *frame = &g_rxFrames[g_rxHead];
+	uint8 next;
+
+	switch(g_rxState)
+	{
+	case FRAME_WAIT_START:
+		if(data == FRAME_START_BYTE)
+		{
+			g_rxCrc = 0;
+			g_rxState = FRAME_WAIT_TYPE;
+		}
+		break;
+
+	case FRAME_WAIT_TYPE:
+		frame->type = data;
+		g_rxCrc = FRAME_crc8Update(g_rxCrc, data);
+		g_rxState = FRAME_WAIT_LENGTH;
+		break;
+
+	case FRAME_WAIT_LENGTH:
+		if(data > FRAME_MAX_PAYLOAD)
+		{
+			g_rxState = FRAME_WAIT_START;			/* Corrupted length, wait for the next frame */
+			break;
+		}
+		frame->length = data;
+		g_rxIndex = 0;
+		g_rxCrc = FRAME_crc8Update(g_rxCrc, data);
+		g_rxState = (data == 0) ? FRAME_WAIT_CRC : FRAME_WAIT_PAYLOAD;
+		break;
+
+	case FRAME_WAIT_PAYLOAD:
+		frame->payload[g_rxIndex] = data;
+		g_rxCrc = FRAME_crc8Update(g_rxCrc, data);
+		++g_rxIndex;
+		if(g_rxIndex == frame->length)
+		{
+			g_rxState = FRAME_WAIT_CRC;
+		}
+		break;
+
+	case FRAME_WAIT_CRC:
+		next = (g_rxHead + 1) & (FRAME_QUEUE_SIZE - 1);
+		if((data == g_rxCrc) && (next != g_rxTail))
+		{
+			g_rxHead = next;						/* Publish the frame to the application */
+		}
+		g_rxState = FRAME_WAIT_START;
+		break;
+	}
+}
+
+/*
+ * Description :
+ * Initialize the frame layer and attach its receive state machine to the UART RXC ISR.
+ * UART must be initialized in interrupt mode before calling this function.
+ */
+void FRAME_init(void)
+{
+	g_rxState = FRAME_WAIT_START;
+	g_rxHead = g_rxTail = 0;
+	UART_setRxCallBack(FRAME_rxByte);
+}
+
+/*
+ * Description :
+ * Send a whole frame of the required type with length bytes of payload (payload can be NULL_PTR
+ * when length is 0).
+ */
+void FRAME_send(uint8 type, const uint8 *payload, uint8 length)
+{
+	uint8 i;
+	uint8 crc = 0;
+
+	if(length > FRAME_MAX_PAYLOAD)
+	{
+		length = FRAME_MAX_PAYLOAD;
+	}
+
+	UART_sendByte(FRAME_START_BYTE);
+	UART_sendByte(type);
+	crc = FRAME_crc8Update(crc, type);
+	UART_sendByte(length);
+	crc = FRAME_crc8Update(crc, length);
+	for(i=0 ; i<length ; ++i)
+	{
+		UART_sendByte(payload[i]);
+		crc = FRAME_crc8Update(crc, payload[i]);
+	}
+	UART_sendByte(crc);
+}
+
+/*
+ * Description :
+ * Non-blocking receive. Returns TRUE and copies the oldest received frame if one is available,
+ * FALSE otherwise.
+ */
+uint8 FRAME_tryReceive(Frame_Type *frame)
+{
+	uint8 i;
+
+	if(g_rxHead == g_rxTail)
+	{
+		return FALSE;								/* No frame received yet */
+	}
+
+	frame->type = g_rxFrames[g_rxTail].type;
+	frame->length = g_rxFrames[g_rxTail].length;
+	for(i=0 ; i<frame->length ; ++i)
+	{
+		frame->payload[i] = g_rxFrames[g_rxTail].payload[i];
+	}
+	g_rxTail = (g_rxTail + 1) & (FRAME_QUEUE_SIZE - 1);
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Blocks until a valid frame is received and copies it.
+ */
+void FRAME_receive(Frame_Type *frame)
+{
+	while(!FRAME_tryReceive(frame))
+	{
+		UART_rxPoll();								/* Keeps receiving if called with interrupts disabled */
+	}
+}
+
+/*
+ * Description :
+ * Blocks until a frame of the required type is received, any other frame is discarded.
+ */
+void FRAME_waitFor(uint8 type)
+{
+	Frame_Type frame;
+
+	do
+	{
+		FRAME_receive(&frame);
+	}while(frame.type != type);
+}
+
+/*
+ * Description :
+ * Waits up to timeout_ms milliseconds for a valid frame.
+ * Returns TRUE and copies the frame if it arrived in time, FALSE if the timeout expired.
+ */
+uint8 FRAME_receiveTimeout(Frame_Type *frame, uint16 timeout_ms)
+{
+	uint32 start = Timebase_getMs();
+
+	do
+	{
+		if(FRAME_tryReceive(frame))
+		{
+			return TRUE;
+		}
+		UART_rxPoll();								/* Keeps receiving if called with interrupts disabled */
+	}while((Timebase_getMs() - start) < timeout_ms);
+
+	return FALSE;
+}
+
+/*
+ * Description :
+ * Waits up to timeout_ms milliseconds for a frame of the required type, any other frame is discarded.
+ * Returns TRUE if it arrived in time, FALSE if the timeout expired.
+ */
+uint8 FRAME_waitForTimeout(uint8 type, uint16 timeout_ms)
+{
+	Frame_Type frame;
+	uint32 start = Timebase_getMs();
+	uint16 elapsed = 0;
+
+	while(FRAME_receiveTimeout(&frame, timeout_ms - elapsed))
+	{
+		if(frame.type == type)
+		{
+			return TRUE;
+		}
+		elapsed = (uint16)(Timebase_getMs() - start);
+		if(elapsed >= timeout_ms)
+		{
+			break;
+		}
+	}
+	return FALSE;
+}
+
+/*
+ * Description :
+ * Discards all received frames that the application didn't read yet.
+ */
+void FRAME_flush(void)
+{
+	g_rxTail = g_rxHead;
+}
+
+/*
+ * Description :
+ * Sends a request frame and waits for a reply frame of reply_type, sending the request again every
+ * FRAME_REPLY_TIMEOUT_MS up to FRAME_MAX_RETRIES times. Old frames are flushed before sending.
+ * Returns TRUE and copies the reply (if reply isn't NULL_PTR), FALSE if no reply arrived.
+ * Use it only for requests that are safe to receive more than once.
+ */
+uint8 FRAME_request(uint8 type, const uint8 *payload, uint8 length, uint8 reply_type, Frame_Type *reply)
+{
+	Frame_Type frame;
+	uint32 start = Timebase_getMs();
+	uint32 sent;
+	uint32 waited;
+	uint16 elapsed;
+	uint8 attempt;
+
+	FRAME_flush();
+	for(attempt=0 ; attempt<=FRAME_MAX_RETRIES ; ++attempt)
+	{
+		FRAME_send(type, payload, length);
+		sent = Timebase_getMs();
+
+		/* Waits for the reply until this attempt's deadline, other frames are discarded. The time left is
+		 * computed only before the deadline so a frame arriving just before it can't make it wrap */
+		for(;;)
+		{
+			waited = Timebase_getMs() - sent;
+			if((waited >= FRAME_REPLY_TIMEOUT_MS) ||
+					!FRAME_receiveTimeout(&frame, FRAME_REPLY_TIMEOUT_MS - (uint16)waited))
+			{
+				break;
+			}
+			if(frame.type == reply_type)
+			{
+				/* Records the recovery time when the reply needed a retry */
+				elapsed = (uint16)(Timebase_getMs() - start);
+				if((attempt > 0) && (elapsed > g_maxRecoveryMs))
+				{
+					g_maxRecoveryMs = elapsed;
+				}
+				if(reply != NULL_PTR)
+				{
+					*reply = frame;
+				}
+				return TRUE;
+			}
+		}
+	}
+	return FALSE;
+}
+
+/*
+ * Description :
+ * Returns the longest time in milliseconds that FRAME_request needed to get a reply after at least
+ * one retry (measured recovery time, bounded by FRAME_WORST_RECOVERY_MS).
+ */
+uint16 FRAME_getMaxRecoveryMs(void)
+{
+	return g_maxRecoveryMs;
+}
+
+#if (UART_TRACE)
+/*
+ * Description :
+ * Sends the UART trace (and empties it) in TRACE_START, TRACE_DATA and TRACE_END frames, ecu_id tells
+ * the host decoder which ECU recorded it. Recording is paused while the dump is sent.
+ */
+void FRAME_traceDump(uint8 ecu_id)
+{
+	UART_TraceEntry entry;
+	uint8 payload[FRAME_MAX_PAYLOAD];
+	uint32 now = Timebase_getMs();
+	uint16 lost;
+	uint8 length = 0;
+
+	UART_traceEnable(FALSE);
+
+	lost = UART_traceLost();
+	payload[0] = ecu_id;
+	payload[1] = (uint8)lost;
+	payload[2] = (uint8)(lost >> 8);
+	payload[3] = (uint8)now;
+	payload[4] = (uint8)(now >> 8);
+	payload[5] = (uint8)(now >> 16);
+	payload[6] = (uint8)(now >> 24);
+	FRAME_send(TRACE_START, payload, 7);
+
+	while(UART_traceRead(&entry))
+	{
+		payload[length] = (uint8)entry.time;
+		payload[length + 1] = (uint8)(entry.time >> 8);
+		payload[length + 2] = entry.flags;
+		payload[length + 3] = entry.data;
+		length += TRACE_ENTRY_SIZE;
+		if(length == FRAME_MAX_PAYLOAD)
+		{
+			FRAME_send(TRACE_DATA, payload, length);
+			length = 0;
+		}
+	}
+	if(length > 0)
+	{
+		FRAME_send(TRACE_DATA, payload, length);
+	}
+	FRAME_send(TRACE_END, NULL_PTR, 0);
+
+	/* The dump bytes are still in the TX buffer, they mustn't be recorded */
+	UART_flushTx();
+	UART_traceEnable(TRUE);
+}
+#endif
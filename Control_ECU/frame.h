@@ -0,0 +1,192 @@
+/******************************************************************************************************
+File Name	: frame.h
+Author		: Sherif Beshr
+Description : Header file for the framed link protocol shared by the HMI and Control ECUs
+*******************************************************************************************************/
+
+#ifndef FRAME_H_
+#define FRAME_H_
+
+#include "std_types.h"
+#include "uart.h"
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+/*
+ * Frame format on the UART link:
+ * | START (0x7E) | TYPE | LENGTH | PAYLOAD (LENGTH bytes) | CRC-8 |
+ * CRC-8 (polynomial 0x07, initial value 0x00) is computed over TYPE, LENGTH and PAYLOAD.
+ */
+#define FRAME_START_BYTE			0x7E
+#define FRAME_CRC8_POLY				0x07
+#define FRAME_MAX_PAYLOAD			16
+
+/* Number of received frames waiting for the application ( Must be a power of 2 ) */
+#define FRAME_QUEUE_SIZE			4
+
+/*
+ * Request/reply deadlines: a request is sent again if its reply doesn't arrive within
+ * FRAME_REPLY_TIMEOUT_MS, up to FRAME_MAX_RETRIES times. FRAME_WORST_RECOVERY_MS is the longest
+ * time FRAME_request can block before giving up (the measured value is FRAME_getMaxRecoveryMs).
+ */
+#define FRAME_REPLY_TIMEOUT_MS		200
+#define FRAME_MAX_RETRIES			5
+#define FRAME_WORST_RECOVERY_MS		(FRAME_REPLY_TIMEOUT_MS * (FRAME_MAX_RETRIES + 1))
+
+/*********************************************FRAME TYPES**********************************************/
+
+#define CONTROL_ECU_READY 			0x10		/* Payload: | PASSWORD SAVED | FAIL TRIALS LEFT | */
+#define HMI_ECU_READY				0x11
+#define PASS_MATCH					0x12
+#define PASS_UNMATCH				0x13
+#define MAIN_OPTIONS				0x14		/* Payload: selected option key '+', '-' or MAIN_OPTION_USERS */
+#define TIME_15_SEC					0x15
+#define START_TIME_15_SEC			0x16
+#define START_TIME_3_SEC			0x17
+#define TIME_3_SEC					0x18
+#define TIME_60_SEC					0x19
+#define START_TIME_60_SEC			0x20
+#define PASSWORD					0x21		/* Payload: password digits in ASCII ('0' -> '9') */
+#define BAUD_REQUEST				0x22		/* Payload: supported baud rates mask (LSB first) */
+#define BAUD_ACCEPT					0x23		/* Payload: baud rates mask supported by both ECUs (LSB first) */
+#define BAUD_CONFIRM				0x24		/* Sent at the new baud rate by both ECUs */
+
+/* Link trace dump (UART_TRACE = 1), raw frames:
+ * TRACE_START	| ECU ID | LOST ENTRIES (2) | NOW MS (4) |		(multi-byte values LSB first)
+ * TRACE_DATA	up to 4 entries of | TIME (2) | FLAGS | DATA |	(UART_TraceEntry, oldest first)
+ * TRACE_END	no payload */
+#define TRACE_DUMP					0x25		/* Asks the other ECU to dump its trace */
+#define TRACE_START					0x26
+#define TRACE_DATA					0x27
+#define TRACE_END					0x28
+#define TRACE_ENTRY_SIZE			4
+#define TRACE_ECU_HMI				'H'			/* ECU ID of TRACE_START */
+#define TRACE_ECU_CONTROL			'C'
+
+/* User table of the Control ECU (see user_table.h), sent through the link. The table is only changed in an
+ * admin session: MAIN_OPTIONS MAIN_OPTION_USERS then the master password ( same fail trials and alarm as '+' ),
+ * ended by USER_END or after USERS_SESSION_TIMEOUT_MS. Outside it the requests are answered USERS_DENIED.
+ * USER_ADD		| USER ID (2) | PIN DIGITS |
+ * USER_REMOVE	| USER ID (2) |
+ * USER_RESULT	| RESULT | USER ID (2) |	(answer to the 2 requests, USERS_OK .. USERS_DENIED, LSB first)
+ * USER_END		no payload */
+#define MAIN_OPTION_USERS			'U'
+#define USER_ADD					0x29
+#define USER_REMOVE					0x2A
+#define USER_RESULT					0x2C
+#define USER_END					0x2E
+
+/* Cycle count of the password digest on the Control ECU (DIGEST_BENCHMARK = 1, see digest.h), through the
+ * link:
+ * DIGEST_BENCH	request: no payload, answer: | HASH CYCLES (4) | VERIFY CYCLES (4) |	(LSB first) */
+#ifndef DIGEST_BENCHMARK
+#define DIGEST_BENCHMARK			0
+#endif
+#define DIGEST_BENCH				0x2D
+
+/* Link layer frames (see link.h) */
+#define LINK_DATA					0x30		/* Payload: | SEQ | TYPE | PAYLOAD | */
+#define LINK_ACK					0x31		/* Payload: | NEXT EXPECTED SEQ | */
+
+/***************************************************************************************************
+ *                                		Types Decelerations                                  	   *
+ ***************************************************************************************************/
+
+/*	Structure that holds one frame:
+ *  1- Type of the message (one of the frame types above)
+ *  2- Number of payload bytes
+ *  3- Payload bytes
+ */
+typedef struct
+{
+	uint8	type;
+	uint8	length;
+	uint8	payload[FRAME_MAX_PAYLOAD];
+}Frame_Type;
+
+/***************************************************************************************************
+ *                                		Function Prototypes                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Initialize the frame layer and attach its receive state machine to the UART RXC ISR.
+ * UART must be initialized in interrupt mode before calling this function.
+ */
+void FRAME_init(void);
+
+/*
+ * Description :
+ * Send a whole frame of the required type with length bytes of payload (payload can be NULL_PTR
+ * when length is 0).
+ */
+void FRAME_send(uint8 type, const uint8 *payload, uint8 length);
+
+/*
+ * Description :
+ * Non-blocking receive. Returns TRUE and copies the oldest received frame if one is available,
+ * FALSE otherwise.
+ */
+uint8 FRAME_tryReceive(Frame_Type *frame);
+
+/*
+ * Description :
+ * Blocks until a valid frame is received and copies it.
+ */
+void FRAME_receive(Frame_Type *frame);
+
+/*
+ * Description :
+ * Blocks until a frame of the required type is received, any other frame is discarded.
+ */
+void FRAME_waitFor(uint8 type);
+
+/*
+ * Description :
+ * Waits up to timeout_ms milliseconds for a valid frame.
+ * Returns TRUE and copies the frame if it arrived in time, FALSE if the timeout expired.
+ */
+uint8 FRAME_receiveTimeout(Frame_Type *frame, uint16 timeout_ms);
+
+/*
+ * Description :
+ * Waits up to timeout_ms milliseconds for a frame of the required type, any other frame is discarded.
+ * Returns TRUE if it arrived in time, FALSE if the timeout expired.
+ */
+uint8 FRAME_waitForTimeout(uint8 type, uint16 timeout_ms);
+
+/*
+ * Description :
+ * Discards all received frames that the application didn't read yet.
+ */
+void FRAME_flush(void);
+
+/*
+ * Description :
+ * Sends a request frame and waits for a reply frame of reply_type, sending the request again every
+ * FRAME_REPLY_TIMEOUT_MS up to FRAME_MAX_RETRIES times. Old frames are flushed before sending.
+ * Returns TRUE and copies the reply (if reply isn't NULL_PTR), FALSE if no reply arrived.
+ * Use it only for requests that are safe to receive more than once.
+ */
+uint8 FRAME_request(uint8 type, const uint8 *payload, uint8 length, uint8 reply_type, Frame_Type *reply);
+
+/*
+ * Description :
+ * Returns the longest time in milliseconds that FRAME_request needed to get a reply after at least
+ * one retry (measured recovery time, bounded by FRAME_WORST_RECOVERY_MS).
+ */
+uint16 FRAME_getMaxRecoveryMs(void);
+
+#if (UART_TRACE)
+/*
+ * Description :
+ * Sends the UART trace (and empties it) in TRACE_START, TRACE_DATA and TRACE_END frames, ecu_id tells
+ * the host decoder which ECU recorded it. Recording is paused while the dump is sent.
+ */
+void FRAME_traceDump(uint8 ecu_id);
+#endif
+
+
+#endif /* FRAME_H_ */
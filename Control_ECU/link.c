@@ -0,0 +1,526 @@
+/******************************************************************************************************
+File Name	: link.c
+Author		: Sherif Beshr
+Description : Source file for the reliable link layer (sequence numbers, ACK and retransmission)
+			  on top of the frame layer, shared by the HMI and Control ECUs
+*******************************************************************************************************/
+
+#include "link.h"
+#include "timebase.h"
+#include "uart.h"
+
+#if (LINK_WINDOW_SIZE != 1) && (LINK_WINDOW_SIZE != 2) && (LINK_WINDOW_SIZE != 4)
+#error "LINK_WINDOW_SIZE must be 1, 2 or 4"
+#endif
+
+/***************************************************************************************************
+ *                                		Types Decelerations                                  	   *
+ ***************************************************************************************************/
+
+/*	Sent message waiting for its ACK	*/
+typedef struct
+{
+	Frame_Type	frame;					/* LINK_DATA frame as sent */
+	uint32		sentMs;					/* Time of the last (re)transmission */
+	uint8		retransmitted;			/* TRUE once sent again, no RTT sample is taken then */
+}Link_TxSlot;
+
+/*	State of one link	*/
+typedef struct
+{
+	Link_TxSlot	tx[LINK_WINDOW_SIZE];	/* Slot of a sequence number is (seq % LINK_WINDOW_SIZE) */
+	uint8		txBase;					/* Oldest unacknowledged sequence number */
+	uint8		txNext;					/* Next sequence number to send */
+	uint8		rxExpected;				/* Next in order sequence number to receive */
+	uint8		retries;				/* RTO expiries in a row without ACK progress */
+	uint8		error;
+	uint16		rtoMs;
+	Frame_Type	rx[LINK_RX_QUEUE_SIZE];	/* Messages delivered in order to the application */
+	uint8		rxHead;
+	uint8		rxTail;
+	uint8		rawPending;				/* TRUE while a handshake frame is the last one in the rx queue */
+	LINK_Stats	stats;
+}Link_Type;
+
+/***************************************************************************************************
+ *                                		Global Variables                                    	   *
+ ***************************************************************************************************/
+
+static Link_Type g_link;
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Adds a frame to the queue of messages delivered to the application.
+ * Returns FALSE if the queue is full.
+ */
+static uint8 LINK_deliver(uint8 type, const uint8 *payload, uint8 length)
+{
+	uint8 next = (g_link.rxHead + 1) & (LINK_RX_QUEUE_SIZE - 1);
+	Frame_Type *frame = &g_link.rx[g_link.rxHead];
+	uint8 i;
+
+	if(next == g_link.rxTail)
+	{
+		return FALSE;
+	}
+	frame->type = type;
+	frame->length = length;
+	for(i=0 ; i<length ; ++i)
+	{
+		frame->payload[i] = payload[i];
+	}
+	g_link.rxHead = next;
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Updates the smoothed RTT (1/8 of each new sample) and the RTO with a new RTT sample.
+ */
+static void LINK_rttSample(uint16 rtt)
+{
+	uint16 rto;
+
+	g_link.stats.rttLastMs = rtt;
+	if(rtt > g_link.stats.rttMaxMs)
+	{
+		g_link.stats.rttMaxMs = rtt;
+	}
+	if(g_link.stats.rttSmoothMs == 0)
+	{
+		g_link.stats.rttSmoothMs = rtt;
+	}
+	else
+	{
+		g_link.stats.rttSmoothMs = (uint16)(((uint32)g_link.stats.rttSmoothMs * 7 + rtt) / 8);
+	}
+
+	rto = 2 * g_link.stats.rttSmoothMs;
+	if(rto < LINK_MIN_RTO_MS)
+	{
+		rto = LINK_MIN_RTO_MS;
+	}
+	else if(rto > LINK_MAX_RTO_MS)
+	{
+		rto = LINK_MAX_RTO_MS;
+	}
+	g_link.rtoMs = rto;
+}
+
+/*
+ * Description :
+ * Handles a cumulative ACK: frees all the acknowledged slots and takes RTT samples.
+ */
+static void LINK_ackReceived(uint8 ack)
+{
+	uint32 now = Timebase_getMs();
+	uint8 outstanding = (uint8)(g_link.txNext - g_link.txBase);
+	Link_TxSlot *slot;
+
+	/* Ignore old or invalid ACKs */
+	if(((uint8)(ack - g_link.txBase) == 0) || ((uint8)(ack - g_link.txBase) > outstanding))
+	{
+		return;
+	}
+
+	while(g_link.txBase != ack)
+	{
+		slot = &g_link.tx[g_link.txBase % LINK_WINDOW_SIZE];
+		if(!slot->retransmitted)
+		{
+			LINK_rttSample((uint16)(now - slot->sentMs));
+		}
+		++g_link.txBase;
+	}
+	g_link.retries = 0;
+}
+
+/*
+ * Description :
+ * Handles a LINK_DATA frame: delivers it if it is the next one in order, then acknowledges all the
+ * frames received in order so far.
+ */
+static void LINK_dataReceived(const Frame_Type *frame)
+{
+	if(frame->length < 2)
+	{
+		return;
+	}
+
+	if((frame->payload[0] == g_link.rxExpected) &&
+			LINK_deliver(frame->payload[1], &frame->payload[2], frame->length - 2))
+	{
+		++g_link.rxExpected;
+		++g_link.stats.rxFrames;
+	}
+	else if(frame->payload[0] != g_link.rxExpected)
+	{
+		++g_link.stats.duplicates;			/* Repeated or out of order (go-back-N resends it) */
+	}
+	FRAME_send(LINK_ACK, &g_link.rxExpected, 1);
+}
+
+/*
+ * Description :
+ * Sends again all the unacknowledged frames when the RTO of the oldest one expired.
+ */
+static void LINK_checkRetransmit(void)
+{
+	uint32 now = Timebase_getMs();
+	Link_TxSlot *slot;
+	uint8 seq;
+
+	if((g_link.txBase == g_link.txNext) || g_link.error)
+	{
+		return;
+	}
+	if((now - g_link.tx[g_link.txBase % LINK_WINDOW_SIZE].sentMs) < g_link.rtoMs)
+	{
+		return;
+	}
+
+	if(g_link.retries >= LINK_MAX_RETRIES)
+	{
+		g_link.error = TRUE;
+		++g_link.stats.linkErrors;
+		return;
+	}
+	++g_link.retries;
+
+	/* Back off so a slow link isn't flooded */
+	g_link.rtoMs = (g_link.rtoMs >= (LINK_MAX_RTO_MS / 2)) ? LINK_MAX_RTO_MS : (2 * g_link.rtoMs);
+
+	for(seq=g_link.txBase ; seq!=g_link.txNext ; ++seq)
+	{
+		slot = &g_link.tx[seq % LINK_WINDOW_SIZE];
+		FRAME_send(slot->frame.type, slot->frame.payload, slot->frame.length);
+		slot->sentMs = now;
+		slot->retransmitted = TRUE;
+		++g_link.stats.retransmits;
+	}
+}
+
+/*
+ * Description :
+ * Initialize the frame layer and the link state. UART must be initialized in interrupt mode and the
+ * time base must be running.
+ */
+void LINK_init(void)
+{
+	FRAME_init();
+	g_link.stats.txFrames = 0;
+	g_link.stats.retransmits = 0;
+	g_link.stats.rxFrames = 0;
+	g_link.stats.duplicates = 0;
+	g_link.stats.rttLastMs = 0;
+	g_link.stats.rttSmoothMs = 0;
+	g_link.stats.rttMaxMs = 0;
+	g_link.stats.linkErrors = 0;
+	LINK_reset();
+}
+
+/*
+ * Description :
+ * Starts a new session: sequence numbers back to 0, unacknowledged and received messages dropped and
+ * link error cleared. Both ECUs reset their link during the HMI_ECU_READY handshake.
+ */
+void LINK_reset(void)
+{
+	g_link.txBase = 0;
+	g_link.txNext = 0;
+	g_link.rxExpected = 0;
+	g_link.retries = 0;
+	g_link.error = FALSE;
+	g_link.rtoMs = LINK_INITIAL_RTO_MS;
+	g_link.rxHead = 0;
+	g_link.rxTail = 0;
+	g_link.rawPending = FALSE;
+}
+
+/*
+ * Description :
+ * Processes the received frames (ACKs, data, handshake) and sends again the frames whose RTO expired.
+ * Called by all the other link functions, call it in any long wait to keep the link running.
+ */
+void LINK_poll(void)
+{
+	Frame_Type frame;
+
+	UART_rxPoll();							/* Keeps receiving if called with interrupts disabled */
+
+	/* A node of the MPCM bus that isn't addressed can't send: the unacknowledged frames are dropped
+	 * instead of being sent again while another door is addressed (its ACKs are dropped by the UART) */
+	if(!UART_isAddressed())
+	{
+		g_link.txBase = g_link.txNext;
+		g_link.retries = 0;
+	}
+
+	/* Frames after a handshake belong to the new session, they wait until the application read the
+	 * handshake frame (and reset the link) */
+	while(!g_link.rawPending && FRAME_tryReceive(&frame))
+	{
+		if(frame.type == LINK_ACK)
+		{
+			if(frame.length == 1)
+			{
+				LINK_ackReceived(frame.payload[0]);
+			}
+		}
+		else if(frame.type == LINK_DATA)
+		{
+			LINK_dataReceived(&frame);
+		}
+		else
+		{
+			/* Session handshake frames go to the application without sequence number */
+			g_link.rawPending = LINK_deliver(frame.type, frame.payload, frame.length);
+		}
+	}
+	LINK_checkRetransmit();
+}
+
+/*
+ * Description :
+ * Sends a message reliably. Blocks only while the window is full.
+ * Returns FALSE if the link is in error, TRUE otherwise.
+ */
+uint8 LINK_send(uint8 type, const uint8 *payload, uint8 length)
+{
+	Link_TxSlot *slot;
+	uint8 i;
+
+	/* Waits for a free slot in the window */
+	while((uint8)(g_link.txNext - g_link.txBase) >= LINK_WINDOW_SIZE)
+	{
+		if(g_link.error)
+		{
+			return FALSE;
+		}
+		LINK_poll();
+	}
+	if(g_link.error)
+	{
+		return FALSE;
+	}
+
+	if(length > LINK_MAX_PAYLOAD)
+	{
+		length = LINK_MAX_PAYLOAD;
+	}
+	slot = &g_link.tx[g_link.txNext % LINK_WINDOW_SIZE];
+	slot->frame.type = LINK_DATA;
+	slot->frame.length = length + 2;
+	slot->frame.payload[0] = g_link.txNext;
+	slot->frame.payload[1] = type;
+	for(i=0 ; i<length ; ++i)
+	{
+		slot->frame.payload[i + 2] = payload[i];
+	}
+	slot->retransmitted = FALSE;
+	slot->sentMs = Timebase_getMs();
+	++g_link.txNext;
+	++g_link.stats.txFrames;
+
+	FRAME_send(slot->frame.type, slot->frame.payload, slot->frame.length);
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Non-blocking receive of the oldest delivered message. Returns TRUE and copies it if available.
+ */
+uint8 LINK_tryReceive(Frame_Type *frame)
+{
+	if(g_link.rxHead == g_link.rxTail)
+	{
+		LINK_poll();
+		if(g_link.rxHead == g_link.rxTail)
+		{
+			return FALSE;
+		}
+	}
+	*frame = g_link.rx[g_link.rxTail];
+	g_link.rxTail = (g_link.rxTail + 1) & (LINK_RX_QUEUE_SIZE - 1);
+	if(g_link.rxHead == g_link.rxTail)
+	{
+		g_link.rawPending = FALSE;			/* The handshake frame is always the last one delivered */
+	}
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Blocks until a message is delivered. Returns FALSE if the link is in error.
+ */
+uint8 LINK_receive(Frame_Type *frame)
+{
+	while(!LINK_tryReceive(frame))
+	{
+		if(g_link.error)
+		{
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Waits up to timeout_ms milliseconds for a message.
+ * Returns TRUE and copies it, FALSE if the timeout expired or the link is in error.
+ */
+uint8 LINK_receiveTimeout(Frame_Type *frame, uint16 timeout_ms)
+{
+	uint32 start = Timebase_getMs();
+
+	do
+	{
+		if(LINK_tryReceive(frame))
+		{
+			return TRUE;
+		}
+		if(g_link.error)
+		{
+			return FALSE;
+		}
+	}while((Timebase_getMs() - start) < timeout_ms);
+
+	return FALSE;
+}
+
+/*
+ * Description :
+ * Waits up to timeout_ms milliseconds for a message of the required type, others are discarded.
+ * Returns TRUE and copies it (if frame isn't NULL_PTR), FALSE on timeout or link error.
+ */
+uint8 LINK_waitForTimeout(uint8 type, Frame_Type *frame, uint16 timeout_ms)
+{
+	Frame_Type received;
+	uint32 start = Timebase_getMs();
+	uint16 elapsed = 0;
+
+	while(LINK_receiveTimeout(&received, timeout_ms - elapsed))
+	{
+		if(received.type == type)
+		{
+			if(frame != NULL_PTR)
+			{
+				*frame = received;
+			}
+			return TRUE;
+		}
+		elapsed = (uint16)(Timebase_getMs() - start);
+		if(elapsed >= timeout_ms)
+		{
+			break;
+		}
+	}
+	return FALSE;
+}
+
+/*
+ * Description :
+ * Sends a message and waits up to LINK_WORST_DELIVERY_MS for a reply of reply_type (copied if reply
+ * isn't NULL_PTR). Returns TRUE if the reply arrived, FALSE otherwise.
+ */
+uint8 LINK_request(uint8 type, const uint8 *payload, uint8 length, uint8 reply_type, Frame_Type *reply)
+{
+	if(!LINK_send(type, payload, length))
+	{
+		return FALSE;
+	}
+	return LINK_waitForTimeout(reply_type, reply, LINK_WORST_DELIVERY_MS);
+}
+
+/*
+ * Description :
+ * Steps the baud rate up to the highest rate supported by both ECUs (called by the HMI after the ready
+ * handshake). Returns TRUE if the new rate is confirmed, FALSE if the link stays at UART_START_BAUD.
+ */
+uint8 LINK_stepUpBaud(void)
+{
+	Frame_Type reply;
+	UART_BaudRate baud;
+	uint16 mask = UART_getSupportedBauds();
+	uint8 payload[2];
+
+	payload[0] = (uint8)mask;
+	payload[1] = (uint8)(mask >> 8);
+	if(!FRAME_request(BAUD_REQUEST, payload, 2, BAUD_ACCEPT, &reply) || (reply.length != 2))
+	{
+		return FALSE;
+	}
+
+	baud = UART_getHighestBaud(reply.payload[0] | ((uint16)reply.payload[1] << 8));
+	if(baud == UART_START_BAUD)
+	{
+		return FALSE;						/* No faster common rate */
+	}
+
+	UART_setBaudRate(baud);
+	if(FRAME_request(BAUD_CONFIRM, NULL_PTR, 0, BAUD_CONFIRM, NULL_PTR))
+	{
+		return TRUE;
+	}
+	UART_setBaudRate(UART_START_BAUD);
+	return FALSE;
+}
+
+/*
+ * Description :
+ * Answers a BAUD_REQUEST frame of the other ECU and switches to the highest common baud rate, going back
+ * to UART_START_BAUD if BAUD_CONFIRM doesn't arrive. Returns TRUE if the new rate is confirmed.
+ */
+uint8 LINK_acceptBaud(const Frame_Type *request)
+{
+	UART_BaudRate baud;
+	uint16 mask = 0;
+	uint8 payload[2];
+
+	if(request->length == 2)
+	{
+		mask = (request->payload[0] | ((uint16)request->payload[1] << 8)) & UART_getSupportedBauds();
+	}
+	payload[0] = (uint8)mask;
+	payload[1] = (uint8)(mask >> 8);
+	FRAME_send(BAUD_ACCEPT, payload, 2);
+
+	baud = UART_getHighestBaud(mask);
+	if(baud == UART_START_BAUD)
+	{
+		return FALSE;
+	}
+
+	/* BAUD_ACCEPT is sent at the old rate before switching */
+	UART_setBaudRate(baud);
+	if(LINK_waitForTimeout(BAUD_CONFIRM, NULL_PTR, LINK_BAUD_CONFIRM_TIMEOUT_MS))
+	{
+		FRAME_send(BAUD_CONFIRM, NULL_PTR, 0);
+		return TRUE;
+	}
+	UART_setBaudRate(UART_START_BAUD);
+	return FALSE;
+}
+
+/*
+ * Description :
+ * Returns TRUE if the link gave up after LINK_MAX_RETRIES timeouts in a row.
+ */
+uint8 LINK_isError(void)
+{
+	return g_link.error;
+}
+
+/*
+ * Description :
+ * Copies the link counters.
+ */
+void LINK_getStats(LINK_Stats *stats)
+{
+	*stats = g_link.stats;
+}
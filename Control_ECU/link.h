@@ -0,0 +1,163 @@
+/******************************************************************************************************
+File Name	: link.h
+Author		: Sherif Beshr
+Description : Header file for the reliable link layer (sequence numbers, ACK and retransmission)
+			  on top of the frame layer, shared by the HMI and Control ECUs
+*******************************************************************************************************/
+
+#ifndef LINK_H_
+#define LINK_H_
+
+#include "std_types.h"
+#include "frame.h"
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+/*
+ * Go-back-N sliding window:
+ * - Every message is sent in a LINK_DATA frame: | SEQ | TYPE | PAYLOAD |
+ * - The receiver answers with a LINK_ACK frame: | NEXT EXPECTED SEQ | (cumulative ACK)
+ * - The oldest unacknowledged frame and everything after it is sent again when the retransmission
+ *   timeout (RTO) expires. RTO = 2 x smoothed RTT, doubled after each timeout, limited to
+ *   LINK_MIN_RTO_MS -> LINK_MAX_RTO_MS. After LINK_MAX_RETRIES timeouts in a row the link is in error
+ *   until LINK_reset.
+ * Frames that are not LINK_DATA/LINK_ACK (session handshake) are passed to the application as is.
+ */
+#define LINK_WINDOW_SIZE			4			/* Frames sent without ACK ( 1, 2 or 4 ) */
+#define LINK_RX_QUEUE_SIZE			4			/* Frames waiting for the application ( Must be a power of 2 ) */
+#define LINK_MAX_PAYLOAD			(FRAME_MAX_PAYLOAD - 2)
+
+#define LINK_INITIAL_RTO_MS			200
+#define LINK_MIN_RTO_MS				50
+#define LINK_MAX_RTO_MS				400
+#define LINK_MAX_RETRIES			5
+
+/* Longest time a message can take to be delivered before the link gives up */
+#define LINK_WORST_DELIVERY_MS		(LINK_MAX_RTO_MS * (LINK_MAX_RETRIES + 1))
+
+/*
+ * Baud rate step up after the ready handshake (raw frames, both ECUs start at UART_START_BAUD):
+ * 1- HMI sends BAUD_REQUEST with its supported rates, Control answers BAUD_ACCEPT with the common ones
+ * 2- Both switch to the highest common rate, HMI sends BAUD_CONFIRM and Control answers BAUD_CONFIRM
+ * 3- A side that doesn't get BAUD_CONFIRM within LINK_BAUD_CONFIRM_TIMEOUT_MS goes back to
+ *    UART_START_BAUD (the HMI handshake tries every supported rate, so a mismatch is recovered)
+ */
+#define LINK_BAUD_CONFIRM_TIMEOUT_MS	FRAME_WORST_RECOVERY_MS
+
+/***************************************************************************************************
+ *                                		Types Decelerations                                  	   *
+ ***************************************************************************************************/
+
+/*	Link counters used to tune the baud rate and window size:
+ *  1- Messages sent for the first time / frames sent again
+ *  2- Messages delivered to the application / repeated or out of order frames dropped
+ *  3- Last, smoothed and maximum round trip time in ms (frames that were sent again are not measured)
+ *  4- Number of times the link gave up (LINK_MAX_RETRIES reached)
+ */
+typedef struct
+{
+	uint16	txFrames;
+	uint16	retransmits;
+	uint16	rxFrames;
+	uint16	duplicates;
+	uint16	rttLastMs;
+	uint16	rttSmoothMs;
+	uint16	rttMaxMs;
+	uint8	linkErrors;
+}LINK_Stats;
+
+/***************************************************************************************************
+ *                                		Function Prototypes                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Initialize the frame layer and the link state. UART must be initialized in interrupt mode and the
+ * time base must be running.
+ */
+void LINK_init(void);
+
+/*
+ * Description :
+ * Starts a new session: sequence numbers back to 0, unacknowledged and received messages dropped and
+ * link error cleared. Both ECUs reset their link during the HMI_ECU_READY handshake.
+ */
+void LINK_reset(void);
+
+/*
+ * Description :
+ * Processes the received frames (ACKs, data, handshake) and sends again the frames whose RTO expired.
+ * Called by all the other link functions, call it in any long wait to keep the link running.
+ */
+void LINK_poll(void);
+
+/*
+ * Description :
+ * Sends a message reliably. Blocks only while the window is full.
+ * Returns FALSE if the link is in error, TRUE otherwise.
+ */
+uint8 LINK_send(uint8 type, const uint8 *payload, uint8 length);
+
+/*
+ * Description :
+ * Non-blocking receive of the oldest delivered message. Returns TRUE and copies it if available.
+ */
+uint8 LINK_tryReceive(Frame_Type *frame);
+
+/*
+ * Description :
+ * Blocks until a message is delivered. Returns FALSE if the link is in error.
+ */
+uint8 LINK_receive(Frame_Type *frame);
+
+/*
+ * Description :
+ * Waits up to timeout_ms milliseconds for a message.
+ * Returns TRUE and copies it, FALSE if the timeout expired or the link is in error.
+ */
+uint8 LINK_receiveTimeout(Frame_Type *frame, uint16 timeout_ms);
+
+/*
+ * Description :
+ * Waits up to timeout_ms milliseconds for a message of the required type, others are discarded.
+ * Returns TRUE and copies it (if frame isn't NULL_PTR), FALSE on timeout or link error.
+ */
+uint8 LINK_waitForTimeout(uint8 type, Frame_Type *frame, uint16 timeout_ms);
+
+/*
+ * Description :
+ * Sends a message and waits up to LINK_WORST_DELIVERY_MS for a reply of reply_type (copied if reply
+ * isn't NULL_PTR). Returns TRUE if the reply arrived, FALSE otherwise.
+ */
+uint8 LINK_request(uint8 type, const uint8 *payload, uint8 length, uint8 reply_type, Frame_Type *reply);
+
+/*
+ * Description :
+ * Steps the baud rate up to the highest rate supported by both ECUs (called by the HMI after the ready
+ * handshake). Returns TRUE if the new rate is confirmed, FALSE if the link stays at UART_START_BAUD.
+ */
+uint8 LINK_stepUpBaud(void);
+
+/*
+ * Description :
+ * Answers a BAUD_REQUEST frame of the other ECU and switches to the highest common baud rate, going back
+ * to UART_START_BAUD if BAUD_CONFIRM doesn't arrive. Returns TRUE if the new rate is confirmed.
+ */
+uint8 LINK_acceptBaud(const Frame_Type *request);
+
+/*
+ * Description :
+ * Returns TRUE if the link gave up after LINK_MAX_RETRIES timeouts in a row.
+ */
+uint8 LINK_isError(void);
+
+/*
+ * Description :
+ * Copies the link counters.
+ */
+void LINK_getStats(LINK_Stats *stats);
+
+
+#endif /* LINK_H_ */
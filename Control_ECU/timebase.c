@@ -0,0 +1,189 @@
+/******************************************************************************************************
+File Name	: timebase.c
+Author		: Sherif Beshr
+Description : Source file for the millisecond / microsecond time base built on Timer0
+*******************************************************************************************************/
+
+#include "timebase.h"
+#include "timer.h"
+#include "common_macros.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+/***************************************************************************************************
+ *                                		Global Variables                                    	   *
+ ***************************************************************************************************/
+
+/* Milliseconds counted by the Timer0 compare interrupt ( Timebase_tick is inlined in the ISR with the static
+ * timer dispatch so it is shared with timer.c then ) */
+#if (TIMER_STATIC_DISPATCH)
+volatile uint32 g_timebaseMs = 0;
+#else
+static volatile uint32 g_timebaseMs = 0;
+#endif
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Timer0 call back function, called every 1 ms.
+ */
+#if (!TIMER_STATIC_DISPATCH)
+static void Timebase_tick(void)
+{
+	++g_timebaseMs;
+}
+#endif
+
+/*
+ * Description :
+ * Starts Timer0 as a 1 ms periodic tick. Global interrupts must be enabled for the tick to run.
+ */
+void Timebase_init(void)
+{
+	Timer_ConfigType Timer0;
+	Timer0.Start_value = 0;
+	Timer0.Compare_value = TIMEBASE_COMPARE_VALUE;
+	Timer0.Timerx_ID = TIMER0_ID;
+	Timer0.Timer_mode = TIMER_COMPARE_MODE;
+	Timer0.Timer_Source = TIMER_SOURCE(0, TIMEBASE_TICK_MS);
+	Timer0.Timer_Compare_Match = TIMERx_COMPARE_NORMAL_NO_OCx;
+
+	g_timebaseMs = 0;
+#if (!TIMER_STATIC_DISPATCH)
+	Timer_setCallBack(TIMER0_ID, Timebase_tick);
+#endif
+	Timer_init(&Timer0);
+}
+
+/*
+ * Description :
+ * Returns the number of milliseconds since Timebase_init.
+ * Can be called with interrupts disabled (from another ISR), the pending tick is counted here then.
+ */
+uint32 Timebase_getMs(void)
+{
+	uint32 ms;
+	uint8 sreg = SREG;
+
+	/* The 32-bit counter is read in four instructions so the tick interrupt must not split it */
+	cli();
+	if(BIT_IS_SET(TIFR,OCF0))
+	{
+		/* Tick is pending (interrupts were disabled), count it now and clear the flag */
+		TIFR = (1<<OCF0);
+		++g_timebaseMs;
+	}
+	ms = g_timebaseMs;
+	SREG = sreg;
+
+	return ms;
+}
+
+/*
+ * Description :
+ * Returns the number of microseconds since Timebase_init.
+ * Can be called with interrupts disabled (from another ISR), the pending tick is counted here then.
+ */
+uint32 Timebase_getUs(void)
+{
+	uint32 ms;
+	uint8 count;
+	uint8 sreg = SREG;
+
+	cli();
+	count = TCNT0;
+	if(BIT_IS_SET(TIFR,OCF0))
+	{
+		/* Tick is pending, the count may have been read before or after it cleared: read it again */
+		TIFR = (1<<OCF0);
+		++g_timebaseMs;
+		count = TCNT0;
+	}
+	ms = g_timebaseMs;
+	SREG = sreg;
+
+	return ms * 1000 + (uint16)count * TIMEBASE_US_PER_COUNT;
+}
+
+#if (TIMER_ISR_BENCHMARK)
+/*
+ * Description :
+ * Returns the CPU cycles of one Timer0 compare ISR from the interrupt to the end of its reti.
+ * Timer2 counts CPU cycles around "sei, nop, cli" ( an interrupt pending at sei runs after the nop ) once with
+ * the tick pending and once without: the difference is the whole ISR, vector jump and reti included.
+ * Interrupts stay enabled until the tick is TIMEBASE_BENCH_LEAD counts away and the other sources are masked
+ * in the windows so only the tick is counted. Returns TIMEBASE_CYCLES_OVERFLOW if Timer2 wrapped.
+ */
+uint8 Timebase_measureTickCycles(void)
+{
+	uint8 withTick;
+	uint8 withoutTick;
+	uint8 overflow;
+	uint8 count;
+	uint8 ucsrb;
+	uint8 timsk;
+	uint8 twcr;
+	uint8 gicr;
+	uint8 sreg = SREG;
+
+	TCCR2 = (1<<FOC2) | (1<<CS20);								/* Normal mode, no pre-scaling */
+
+	/* The UART and the other ISRs keep running while waiting for the last counts before the tick */
+	for(;;)
+	{
+		cli();
+		count = TCNT0;
+		if((count >= (TIMEBASE_COMPARE_VALUE - TIMEBASE_BENCH_LEAD)) && (count < TIMEBASE_COMPARE_VALUE) &&
+				BIT_IS_CLEAR(TIFR,OCF0))
+		{
+			break;
+		}
+		sei();
+	}
+
+	/* Only the tick may interrupt the windows, the flags of the other sources stay pending. TWINT is
+	 * cleared by writing one and TWSTO would send a stop, both are written as zero */
+	ucsrb = UCSRB;
+	timsk = TIMSK;
+	twcr = TWCR & ~((1<<TWINT) | (1<<TWSTO));
+	gicr = GICR;
+	UCSRB = ucsrb & ~((1<<RXCIE) | (1<<TXCIE) | (1<<UDRIE));
+	TIMSK = timsk & (1<<OCIE0);
+	TWCR = twcr & ~(1<<TWIE);
+	GICR = gicr & ~((1<<INT0) | (1<<INT1) | (1<<INT2));
+
+	while(BIT_IS_CLEAR(TIFR,OCF0));								/* Tick pending */
+
+	TIFR = (1<<TOV2);
+	TCNT2 = 0;
+	sei();
+	__asm__ __volatile__ ("nop");								/* Tick ISR runs here */
+	cli();
+	withTick = TCNT2;
+	overflow = BIT_IS_SET(TIFR,TOV2);
+
+	TIFR = (1<<TOV2);
+	TCNT2 = 0;
+	sei();
+	__asm__ __volatile__ ("nop");								/* Nothing pending, the next tick is 1 ms away */
+	cli();
+	withoutTick = TCNT2;
+	overflow |= BIT_IS_SET(TIFR,TOV2);
+
+	UCSRB = ucsrb;
+	TIMSK = timsk;
+	TWCR = twcr;
+	GICR = gicr;
+	TCCR2 = 0;
+	SREG = sreg;
+
+	if(overflow || (withTick < withoutTick))
+	{
+		return TIMEBASE_CYCLES_OVERFLOW;
+	}
+	return withTick - withoutTick;
+}
+#endif
@@ -0,0 +1,92 @@
+/******************************************************************************************************
+File Name	: timebase.h
+Author		: Sherif Beshr
+Description : Header file for the millisecond / microsecond time base built on Timer0
+*******************************************************************************************************/
+
+#ifndef TIMEBASE_H_
+#define TIMEBASE_H_
+
+#include "std_types.h"
+#include "timer.h"
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+/* Timer0 compare mode, one interrupt every 1 ms ( 8MHz: pre-scalar 64 so 125 counts of 8 us, 0 -> 124 ) */
+#define TIMEBASE_TICK_MS				1
+#define TIMEBASE_COMPARE_VALUE			TIMER_COMPARE(0, TIMEBASE_TICK_MS)
+#define TIMEBASE_US_PER_COUNT			((TIMER_DIVIDER(0, TIMEBASE_TICK_MS) * 1000000UL) / (F_CPU))
+
+#if (TIMER_TICKS(0, TIMEBASE_TICK_MS) != 1) || !TIMER_IS_VALID(0, TIMEBASE_TICK_MS)
+#error "Timer0 can't count exact milliseconds at this F_CPU"
+#endif
+#if (((TIMER_DIVIDER(0, TIMEBASE_TICK_MS) * 1000000UL) % (F_CPU)) != 0)
+#error "A Timer0 count must be a whole number of microseconds for Timebase_getUs"
+#endif
+
+/* Timebase_measureTickCycles: Timer0 counts before the tick from which the interrupts are disabled
+ * ( 2 x 64 CPU cycles at 8 MHz ), and the result if Timer2 wrapped */
+#define TIMEBASE_BENCH_LEAD				2
+#define TIMEBASE_CYCLES_OVERFLOW		0xFF
+
+#if (TIMER_STATIC_DISPATCH)
+/***************************************************************************************************
+ *                                		Global Variables                                    	   *
+ ***************************************************************************************************/
+
+/* Milliseconds counted by the Timer0 compare interrupt ( defined in timebase.c ) */
+extern volatile uint32 g_timebaseMs;
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Timer0 compare handler, every 1 ms. Inlined into the ISR by the static timer dispatch ( timer_cfg.h ).
+ */
+static inline void Timebase_tick(void)
+{
+	++g_timebaseMs;
+}
+#endif
+
+/***************************************************************************************************
+ *                                		Function Prototypes                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Starts Timer0 as a 1 ms periodic tick. Global interrupts must be enabled for the tick to run.
+ */
+void Timebase_init(void);
+
+/*
+ * Description :
+ * Returns the number of milliseconds since Timebase_init.
+ * Can be called with interrupts disabled (from another ISR), the pending tick is counted here then.
+ */
+uint32 Timebase_getMs(void);
+
+/*
+ * Description :
+ * Returns the number of microseconds since Timebase_init ( 8 us resolution, wraps after 71 minutes ):
+ * the milliseconds and the Timer0 count read at once. Can be called with interrupts disabled too.
+ */
+uint32 Timebase_getUs(void);
+
+#if (TIMER_ISR_BENCHMARK)
+/*
+ * Description :
+ * Returns the CPU cycles of one Timer0 compare ISR from the interrupt to the end of its reti ( dispatch mode of
+ * timer_cfg.h ), TIMEBASE_CYCLES_OVERFLOW if it took 255 cycles or more. Waits for the next tick ( up to 1 ms )
+ * with interrupts enabled, the other interrupt sources are masked only around the tick. Uses Timer2, which must
+ * be free.
+ */
+uint8 Timebase_measureTickCycles(void);
+#endif
+
+
+#endif /* TIMEBASE_H_ */
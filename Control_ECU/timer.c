@@ -0,0 +1,541 @@
+/******************************************************************************************************
+File Name	: timer.c
+Author		: Sherif Beshr
+Description : Source file for the Timer AVR driver
+ *******************************************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "timer.h"
+#if (TIMER_STATIC_DISPATCH)
+#include "timebase.h"
+#endif
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+#define TIMER_EXPIRED_SLOT				0xFF	/* Slot of the timers expired in the tick being run */
+
+#if ((TIMER_WHEEL_SIZE & (TIMER_WHEEL_SIZE - 1)) != 0)
+#error "TIMER_WHEEL_SIZE must be a power of 2"
+#endif
+
+#if (TIMER_TICKS(1, TIMER_TICK_MS) != 1) || !TIMER_IS_VALID(1, TIMER_TICK_MS)
+#error "TIMER_TICK_MS can't be one exact compare period of Timer1 at this F_CPU"
+#endif
+
+/***************************************************************************************************
+ *                                		Global Variables                                    	   *
+ ***************************************************************************************************/
+
+/* Global variables to hold the address of the call back function in the application */
+static volatile void (*g_Timer0_callBackPtr)(void) = NULL_PTR;
+static volatile void (*g_Timer1_callBackPtr)(void) = NULL_PTR;
+static volatile void (*g_Timer2_callBackPtr)(void) = NULL_PTR;
+
+/* Software timers: list of every slot of the wheel, the expired ones are moved to g_expired in a tick */
+static Timer_SoftTimer *g_wheel[TIMER_WHEEL_SIZE];
+static Timer_SoftTimer *g_expired = NULL_PTR;
+static uint8 g_wheelPosition = 0;
+
+/* Longest tick ISR in Timer1 counts: from the compare match ( the count restarts at 0 ) to the end of the tick */
+static volatile uint16 g_tickMaxCounts = 0;
+
+/***************************************************************************************************
+ *                                		Function Prototypes                                  	   *
+ ***************************************************************************************************/
+
+static void Timer_serviceTick(void);
+
+
+/***************************************************************************************************
+ *                                	Interrupt Service Routine                                      *
+ ***************************************************************************************************/
+
+/*	Timer0 callback function for overflow mode*/
+ISR(TIMER0_OVF_vect)
+{
+	if (g_Timer0_callBackPtr != NULL_PTR)
+	{
+		/* Call the Call Back function in the application after the edge is detected */
+		(*g_Timer0_callBackPtr)(); /* call the function using pointer to function g_Timer0_callBackPtr(); */
+	}
+}
+
+/*	Timer0 callback function for compare mode*/
+ISR(TIMER0_COMP_vect)
+{
+#if (TIMER_STATIC_DISPATCH)
+	TIMER0_COMP_HANDLER();
+#else
+	if (g_Timer0_callBackPtr != NULL_PTR)
+	{
+		/* Call the Call Back function in the application after the edge is detected */
+		(*g_Timer0_callBackPtr)(); /* call the function using pointer to function g_Timer0_callBackPtr(); */
+	}
+#endif
+}
+
+/*	Timer1 callback function for overflow mode*/
+ISR(TIMER1_OVF_vect)
+{
+	if (g_Timer1_callBackPtr != NULL_PTR)
+	{
+		/* Call the Call Back function in the application after the edge is detected */
+		(*g_Timer1_callBackPtr)(); /* call the function using pointer to function g_Timer1_callBackPtr(); */
+	}
+}
+
+/*	Timer1 callback function for compare (A) mode*/
+ISR(TIMER1_COMPA_vect)
+{
+#if (TIMER_STATIC_DISPATCH)
+	TIMER1_COMPA_HANDLER();
+#else
+	if (g_Timer1_callBackPtr != NULL_PTR)
+	{
+		/* Call the Call Back function in the application after the edge is detected */
+		(*g_Timer1_callBackPtr)(); /* call the function using pointer to function g_Timer1_callBackPtr(); */
+	}
+#endif
+}
+
+/*	Timer1 callback function for compare (B) mode*/
+ISR(TIMER1_COMPB_vect)
+{
+	if (g_Timer1_callBackPtr != NULL_PTR)
+	{
+		/* Call the Call Back function in the application after the edge is detected */
+		(*g_Timer1_callBackPtr)(); /* call the function using pointer to function g_Timer1_callBackPtr(); */
+	}
+}
+
+/*	Timer2 callback function for overflow mode*/
+ISR(TIMER2_OVF_vect)
+{
+	if (g_Timer2_callBackPtr != NULL_PTR)
+	{
+		/* Call the Call Back function in the application after the edge is detected */
+		(*g_Timer2_callBackPtr)(); /* call the function using pointer to function g_Timer2_callBackPtr(); */
+	}
+}
+
+/*	Timer2 callback function for compare mode*/
+ISR(TIMER2_COMP_vect)
+{
+	if (g_Timer2_callBackPtr != NULL_PTR)
+	{
+		/* Call the Call Back function in the application after the edge is detected */
+		(*g_Timer2_callBackPtr)(); /* call the function using pointer to function g_Timer2_callBackPtr(); */
+	}
+}
+
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Initialize the Timer with configurable inputs:
+ * 1- Timerx_ID: 			Choose from (TIMER0_ID / TIMER1_ID / TIMER2_ID)
+ * 2- Start Value: 			0 -> 255 (Timer0/Timer2) and 0 -> 65535 (Timer1)
+ * 3- Timer Mode: 			Choose (TIMER_NORMAL_MODE / TIMER_COMPARE_MODE)
+ * 4- Compare Value: 		0 -> 255 (Timer0/Timer2) and 0 -> 65535 (Timer1)
+ * 5- Timerx Source:		Choose from (No Clock/ Pre-scalar / External Clock)
+ * 6- Timer Compare Match:	Choose from (No OCx, Toggle OCx, Clear OCx, Set OCx)	[Only for compare mode]
+ */
+void Timer_init(const Timer_ConfigType* Config_Ptr)
+{
+	switch (Config_Ptr->Timerx_ID)
+	{
+
+	/**************************************************************************)*
+	 *                                	Timer0                   	   			*
+	 ****************************************************************************/
+	case (TIMER0_ID):
+																		/* FOCx is always set when Timer is not in PWM mode. Clears all register */
+																		TCCR0 = (1<<FOC0);
+
+	/* Set the start value */
+	TCNT0 = Config_Ptr->Start_value;
+
+	/* Set the pre-scalar or timer source */
+	TCCR0 = (TCCR0 & 0xF8) | (Config_Ptr->Timer_Source << CS00);
+
+	/* If timer compare mode is selected set the WGM01 = 1
+	 * set the COM0x from compare match mode
+	 * set OCRx value*/
+	if(Config_Ptr->Timer_mode == TIMER_COMPARE_MODE)
+	{
+		TCCR0 = (TCCR0 & 0xB7) | (1<<WGM01);			/* Clears WGM00 and Set WGM01*/
+		TCCR0 = (TCCR0 & 0xCF) | (Config_Ptr->Timer_Compare_Match << COM00);
+		OCR0  = Config_Ptr->Compare_value;
+		TIMSK |= (1<<OCIE0);								/* Enable Timer0 compare interrupt */
+	}
+	else if(Config_Ptr->Timer_mode == TIMER_NORMAL_MODE)
+	{
+		TIMSK |= (1<<TOIE0);								/* Enable Timer0 overflow interrupt */
+	}
+	break;
+
+	/**************************************************************************)*
+	 *                                	Timer1                   	   			*
+	 ****************************************************************************/
+	case (TIMER1_ID):
+																		/* FOCx is always set when Timer is not in PWM mode. Clears all register */
+																		TCCR1A |= (1<<FOC1A) | (1<<FOC1B);
+
+	/* Set the start value */
+	TCNT1 = Config_Ptr->Start_value;
+
+	/* Set the pre-scalar or timer source */
+	TCCR1B = (TCCR1B & 0xF8) | (Config_Ptr->Timer_Source << CS10);
+
+	/* If timer compare mode is selected set the WGM01 = 1
+	 * set the COM0x from compare match mode
+	 * set OCRx value*/
+	if(Config_Ptr->Timer_mode == TIMER_COMPARE_MODE)
+	{
+		TCCR1B = (TCCR1B & 0xE7) | (1<<WGM12);				/* Clears WGM13 and Set WGM12 (Mode 4 CTC)*/
+		TCCR1A = (TCCR1A & 0x3F) | (Config_Ptr->Timer_Compare_Match << COM1A0);
+		OCR1A  = Config_Ptr->Compare_value;
+		TIMSK |= (1<<OCIE1A);								/* Enable Timer1 compare interrupt */
+	}
+	else if(Config_Ptr->Timer_mode == TIMER_NORMAL_MODE)
+	{
+		TIMSK |= (1<<TOIE1);								/* Enable Timer1 overflow interrupt */
+	}
+	break;
+
+
+	/**************************************************************************)*
+	 *                                	Timer2                   	   			*
+	 ****************************************************************************/
+	case (TIMER2_ID):
+																		/* FOCx is always set when Timer is not in PWM mode. Clears all register */
+																		TCCR2 = (1<<FOC2);
+
+	/* Set the start value */
+	TCNT2 = Config_Ptr->Start_value;
+
+	/* Set the pre-scalar or timer source */
+	TCCR2 = (TCCR2 & 0xF8) | (Config_Ptr->Timer_Source << CS20);
+
+	/* If timer compare mode is selected set the WGM01 = 1
+	 * set the COM0x from compare match mode
+	 * set OCRx value*/
+	if(Config_Ptr->Timer_mode == TIMER_COMPARE_MODE)
+	{
+		TCCR2 = (TCCR2 & 0xB7) | (1<<WGM21);			/* Clears WGM20 and Set WGM21*/
+		TCCR2 = (TCCR2 & 0xCF) | (Config_Ptr->Timer_Compare_Match << COM20);
+		OCR2  = Config_Ptr->Compare_value;
+		TIMSK |= (1<<OCIE2);								/* Enable Timer2 compare interrupt */
+	}
+	else if(Config_Ptr->Timer_mode == TIMER_NORMAL_MODE)
+	{
+		TIMSK |= (1<<TOIE2);								/* Enable Timer2 overflow interrupt */
+	}
+	break;
+	}
+}
+
+
+/*
+ * Description: Function to set the Call Back function address.
+ */
+void Timer_setCallBack(Timer_ID timer_ID, void(*a_ptr)(void))
+{
+	if(timer_ID == TIMER0_ID)
+	{
+		/* Save the address of the Call back function in a global variable of Timer0 */
+		g_Timer0_callBackPtr = a_ptr;
+	}
+	else if(timer_ID == TIMER1_ID)
+	{
+		/* Save the address of the Call back function in a global variable of Timer1 */
+		g_Timer1_callBackPtr = a_ptr;
+	}
+	else if(timer_ID == TIMER2_ID)
+	{
+		/* Save the address of the Call back function in a global variable of Timer2 */
+		g_Timer2_callBackPtr = a_ptr;
+	}
+}
+
+
+/*
+ * Description :
+ * De-Initialize the Timerx for the chosen timer (TIMER0_ID / TIMER1_ID / TIMER2_ID)
+ */
+void Timer_deinit(Timer_ID timer_ID)
+{
+	if(timer_ID == TIMER0_ID)				/* De-initialize Timer0 */
+	{
+		TCCR0 = 0;
+		TCNT0 = 0;
+		TIMSK &= ~(1<<TOIE0);
+		TIMSK &= ~(1<<OCIE0);
+	}
+
+	else if(timer_ID == TIMER1_ID)			/* De-initialize Timer1 */
+	{
+		TCCR1A = 0;
+		TCCR1B = 0;
+		TCNT1 = 0;
+		TIMSK &= ~(1<<TOIE1);
+		TIMSK &= ~(1<<OCIE1A);
+		TIMSK &= ~(1<<OCIE1B);
+	}
+
+	else if(timer_ID == TIMER2_ID)			/* De-initialize Timer2 */
+	{
+		TCCR2 = 0;
+		TCNT2 = 0;
+		TIMSK &= ~(1<<TOIE2);
+		TIMSK &= ~(1<<OCIE2);
+	}
+}
+
+/*
+ * Description: Function to set the Initial value of selected timer.
+ */
+void Timer_SetStartValue(Timer_ID timer_ID, uint16 start_value)
+{
+	if(timer_ID == TIMER0_ID)			/* Set initial value for Timer0 */
+	{
+		TCNT0 = start_value;
+	}
+
+	else if(timer_ID == TIMER1_ID)			/* Set initial value for Timer1 */
+	{
+		TCNT1 = start_value;
+	}
+
+	else if(timer_ID == TIMER2_ID)			/* Set initial value for Timer2 */
+	{
+		TCNT2 = start_value;
+	}
+}
+
+/*
+ * Description: Function to set the Compare Value of the selected timer.
+ */
+void Timer_SetCompareValue(Timer_ID timer_ID, uint16 compare_value)
+{
+	if(timer_ID == TIMER0_ID)			/* Set compare value for Timer0 */
+	{
+		OCR0 = compare_value;
+	}
+
+	else if(timer_ID == TIMER1_ID)			/* Set compare value for Timer1 */
+	{
+		OCR1A = compare_value;
+	}
+
+	else if(timer_ID == TIMER2_ID)			/* Set compare value for Timer2 */
+	{
+		OCR2 = compare_value;
+	}
+}
+
+/*
+ * Description :
+ * Returns the head of the list a software timer is linked in.
+ */
+static Timer_SoftTimer **Timer_listHead(uint8 slot)
+{
+	return (slot == TIMER_EXPIRED_SLOT) ? &g_expired : &g_wheel[slot];
+}
+
+/*
+ * Description :
+ * Links a software timer at the head of the list of a slot.
+ */
+static void Timer_link(Timer_SoftTimer *timer, uint8 slot)
+{
+	Timer_SoftTimer **head = Timer_listHead(slot);
+
+	timer->Slot = slot;
+	timer->prev = NULL_PTR;
+	timer->next = *head;
+	if(*head != NULL_PTR)
+	{
+		(*head)->prev = timer;
+	}
+	*head = timer;
+}
+
+/*
+ * Description :
+ * Unlinks a software timer from the list of its slot.
+ */
+static void Timer_unlink(Timer_SoftTimer *timer)
+{
+	if(timer->prev != NULL_PTR)
+	{
+		timer->prev->next = timer->next;
+	}
+	else
+	{
+		*Timer_listHead(timer->Slot) = timer->next;
+	}
+	if(timer->next != NULL_PTR)
+	{
+		timer->next->prev = timer->prev;
+	}
+}
+
+/*
+ * Description :
+ * Puts a software timer in the wheel to expire in ticks ( at least 1 ): in the slot the wheel reaches
+ * after ticks, with the number of whole turns to wait there.
+ */
+static void Timer_insert(Timer_SoftTimer *timer, uint32 ticks)
+{
+	if(ticks == 0)
+	{
+		ticks = 1;
+	}
+	timer->Rounds = (uint16)((ticks - 1) / TIMER_WHEEL_SIZE);
+	timer->Active = TRUE;
+	Timer_link(timer, (uint8)((g_wheelPosition + ticks) & (TIMER_WHEEL_SIZE - 1)));
+}
+
+/*
+ * Description :
+ * Timer1 call back, every TIMER_TICK_MS: moves the wheel to the next slot, the timers of the slot with no
+ * turn left are moved to the expired list then their call backs are called one by one ( a call back can
+ * start or stop any timer, an expired one included ).
+ */
+static void Timer_serviceTick(void)
+{
+	Timer_SoftTimer *timer;
+	Timer_SoftTimer *next;
+
+	g_wheelPosition = (g_wheelPosition + 1) & (TIMER_WHEEL_SIZE - 1);
+	for(timer = g_wheel[g_wheelPosition] ; timer != NULL_PTR ; timer = next)
+	{
+		next = timer->next;
+		if(timer->Rounds > 0)
+		{
+			--timer->Rounds;
+		}
+		else
+		{
+			Timer_unlink(timer);
+			Timer_link(timer, TIMER_EXPIRED_SLOT);
+		}
+	}
+
+	while(g_expired != NULL_PTR)
+	{
+		timer = g_expired;
+		Timer_unlink(timer);
+		timer->Active = FALSE;
+		if(timer->PeriodTicks != 0)
+		{
+			Timer_insert(timer, timer->PeriodTicks);
+		}
+		(*timer->CallBack)();
+	}
+
+	if(TCNT1 > g_tickMaxCounts)
+	{
+		g_tickMaxCounts = TCNT1;
+	}
+}
+
+/*
+ * Description :
+ * Starts the software timers service: Timer1 interrupts every TIMER_TICK_MS and turns the wheel.
+ */
+void Timer_serviceInit(void)
+{
+	Timer_ConfigType Timer1;
+	uint8 slot;
+
+	for(slot=0 ; slot<TIMER_WHEEL_SIZE ; ++slot)
+	{
+		g_wheel[slot] = NULL_PTR;
+	}
+	g_expired = NULL_PTR;
+	g_wheelPosition = 0;
+	g_tickMaxCounts = 0;
+
+	Timer1.Start_value = 0;
+	Timer1.Compare_value = TIMER_COMPARE(1, TIMER_TICK_MS);
+	Timer1.Timerx_ID = TIMER1_ID;
+	Timer1.Timer_mode = TIMER_COMPARE_MODE;
+	Timer1.Timer_Source = TIMER_SOURCE(1, TIMER_TICK_MS);
+	Timer1.Timer_Compare_Match = TIMERx_COMPARE_NORMAL_NO_OCx;
+#if (!TIMER_STATIC_DISPATCH)
+	Timer_setCallBack(TIMER1_ID, Timer_serviceTick);
+#endif
+	Timer_init(&Timer1);
+}
+
+/*
+ * Description :
+ * Starts ( or restarts ) a software timer: the call back is called from the Timer1 ISR after delay_ms
+ * ( rounded up to TIMER_TICK_MS ), then every period_ms if it isn't 0.
+ */
+void Timer_startSoft(Timer_SoftTimer *timer, uint32 delay_ms, uint32 period_ms, void(*a_ptr)(void))
+{
+	uint8 sreg = SREG;
+
+	cli();
+	if(timer->Active)
+	{
+		Timer_unlink(timer);
+	}
+	timer->CallBack = a_ptr;
+	timer->PeriodTicks = (uint16)TIMER_MS_TO_TICKS(period_ms);
+	Timer_insert(timer, TIMER_MS_TO_TICKS(delay_ms));
+	SREG = sreg;
+}
+
+/*
+ * Description :
+ * Stops a software timer, its call back isn't called anymore.
+ */
+void Timer_stopSoft(Timer_SoftTimer *timer)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	if(timer->Active)
+	{
+		Timer_unlink(timer);
+		timer->Active = FALSE;
+	}
+	timer->PeriodTicks = 0;
+	SREG = sreg;
+}
+
+/*
+ * Description :
+ * Returns TRUE while a software timer runs.
+ */
+uint8 Timer_isSoftActive(const Timer_SoftTimer *timer)
+{
+	return timer->Active;
+}
+
+/*
+ * Description :
+ * Returns the longest time in microseconds from a Timer1 tick to the end of its ISR ( the wheel and the call
+ * backs, interrupt latency included ).
+ */
+uint16 Timer_getServiceMaxUs(void)
+{
+	uint16 counts;
+	uint8 sreg = SREG;
+
+	cli();
+	counts = g_tickMaxCounts;
+	SREG = sreg;
+
+	return (uint16)(((uint32)counts * TIMER_DIVIDER(1, TIMER_TICK_MS) * 1000UL) / ((F_CPU) / 1000UL));
+}
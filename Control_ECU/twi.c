@@ -7,13 +7,186 @@ Description : Source file for the TWI(I2C) AVR driver
 
 #include "twi.h"
 #include "common_macros.h"
+#include "timebase.h"
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
 
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+#define TWI_RECOVERY_CLOCKS		9			/* SCL pulses to let a slave finish the byte it sends */
+#define TWI_RECOVERY_HALF_US	5			/* Half period of the recovery clock ( 100 KHz ) */
+#define TWI_SCL_PIN				PC0
+#define TWI_SDA_PIN				PC1
+
+/***************************************************************************************************
+ *                                		Global Variables                                    	   *
+ ***************************************************************************************************/
+
+/* Queue of the asynchronous transactions, the head one is run by the ISR */
+static TWI_Transaction *volatile g_queue[TWI_QUEUE_SIZE];
+static volatile uint8 g_queueHead = 0;
+static volatile uint8 g_queueTail = 0;
+
+/* Position in the running transaction: sub-address bytes, then TX bytes, then RX bytes */
+static uint16 g_index = 0;
+static uint8 g_reading = FALSE;
+static volatile uint32 g_lastEventMs;			/* Last bus event of the running transaction */
+
+static TWI_Stats g_stats;
+
+/***************************************************************************************************
+ *                                	Interrupt Service Routine                                      *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Ends the running transaction with its result: sends a stop (and the start of the next queued
+ * transaction in the same TWCR write) then calls its call back.
+ */
+static void TWI_complete(TWI_Result result)
+{
+	TWI_Transaction *transaction = g_queue[g_queueTail];
+
+	g_queueTail = (g_queueTail + 1) & (TWI_QUEUE_SIZE - 1);
+	g_index = 0;
+	g_reading = FALSE;
+	if(g_queueTail != g_queueHead)
+	{
+		TWCR = (1<<TWINT) | (1<<TWSTO) | (1<<TWSTA) | (1<<TWEN) | (1<<TWIE);
+	}
+	else
+	{
+		TWCR = (1<<TWINT) | (1<<TWSTO) | (1<<TWEN);
+	}
+
+	transaction->Result = result;
+	if(transaction->CallBack != NULL_PTR)
+	{
+		/* The call back can submit the next transaction (e.g. the next EEPROM page) */
+		(*transaction->CallBack)(transaction);
+	}
+}
+
+/*
+ * Description :
+ * Sends the next byte of the sub-address / TX data, or goes to the read part / ends when none is left.
+ */
+static void TWI_sendNext(TWI_Transaction *transaction)
+{
+	if(g_index < transaction->SubAddressLength)
+	{
+		TWDR = transaction->SubAddress[g_index];
+	}
+	else if(g_index < (transaction->SubAddressLength + transaction->TxLength))
+	{
+		TWDR = transaction->TxData[g_index - transaction->SubAddressLength];
+	}
+	else if(transaction->RxLength > 0)
+	{
+		/* Repeated start for the read part */
+		g_reading = TRUE;
+		g_index = 0;
+		TWCR = (1<<TWINT) | (1<<TWSTA) | (1<<TWEN) | (1<<TWIE);
+		return;
+	}
+	else
+	{
+		TWI_complete(TWI_RESULT_OK);
+		return;
+	}
+	++g_index;
+	TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWIE);
+}
+
+/*
+ * Description :
+ * Receives the next byte with ACK, or with NACK if it is the last one.
+ */
+static void TWI_receiveNext(TWI_Transaction *transaction)
+{
+	if((g_index + 1) < transaction->RxLength)
+	{
+		TWCR = (1<<TWINT) | (1<<TWEA) | (1<<TWEN) | (1<<TWIE);
+	}
+	else
+	{
+		TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWIE);
+	}
+}
+
+/*	TWI state machine: one interrupt per bus event of the head transaction of the queue	*/
+ISR(TWI_vect)
+{
+	TWI_Transaction *transaction = g_queue[g_queueTail];
+
+	g_lastEventMs = Timebase_getMs();
+	switch(TWI_getStatus())
+	{
+	case TWI_START:
+	case TWI_REP_START:
+		TWDR = g_reading ? (transaction->SlaveAddress | 1) : transaction->SlaveAddress;
+		TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWIE);
+		break;
+	case TWI_MT_SLA_W_ACK:
+	case TWI_MT_DATA_ACK:
+		TWI_sendNext(transaction);
+		break;
+	case TWI_MT_SLA_R_ACK:
+		TWI_receiveNext(transaction);
+		break;
+	case TWI_MR_DATA_ACK:
+		transaction->RxData[g_index++] = TWDR;
+		TWI_receiveNext(transaction);
+		break;
+	case TWI_MR_DATA_NACK:
+		transaction->RxData[g_index] = TWDR;
+		TWI_complete(TWI_RESULT_OK);
+		break;
+	case TWI_MT_SLA_W_NACK:
+	case TWI_MR_SLA_R_NACK:
+		TWI_complete(TWI_RESULT_ADDRESS_NACK);
+		break;
+	case TWI_MT_DATA_NACK:
+		TWI_complete(TWI_RESULT_DATA_NACK);
+		break;
+	case TWI_ARB_LOST:
+		++g_stats.ArbitrationLost;
+		TWI_complete(TWI_RESULT_ARBITRATION);
+		break;
+	default:
+		++g_stats.BusErrors;
+		TWI_recover();
+		TWI_complete(TWI_RESULT_BUS_ERROR);
+		break;
+	}
+}
 
 /***************************************************************************************************
- *                                		Function Prototypes                                 	   *
+ *                                		Function Definitions                                  	   *
  ***************************************************************************************************/
 
+/*
+ * Description :
+ * Waits for the TWINT flag ( end of the bus event ) until TWI_TIMEOUT_MS, then recovers the bus.
+ */
+static void TWI_wait(void)
+{
+	uint32 start = Timebase_getMs();
+
+	while(BIT_IS_CLEAR(TWCR,TWINT))
+	{
+		if((Timebase_getMs() - start) >= TWI_TIMEOUT_MS)
+		{
+			++g_stats.Timeouts;
+			TWI_recover();
+			return;
+		}
+	}
+}
+
 /*
  * Description :
  * Initialize the TWI with configurable SCL frequency, pre-scalar and address.
@@ -44,6 +217,12 @@ void TWI_init(const TWI_ConfigType* Config_Ptr)
 	TWAR = (TWAR & 0x01) | ((Config_Ptr->Address)<<TWA0);
 	/* Enable the TWI */
 	TWCR = (1<<TWEN);
+
+	g_stats.Timeouts = 0;
+	g_stats.Recoveries = 0;
+	g_stats.StuckBus = 0;
+	g_stats.BusErrors = 0;
+	g_stats.ArbitrationLost = 0;
 }
 
 /*
@@ -57,10 +236,10 @@ void TWI_start(void)
 	 * send the start bit by TWSTA=1
 	 * Enable TWI Module TWEN=1
 	 */
-	TWCR = (1<TWINT) | (1<<TWSTA) | (1<<TWEN);
+	TWCR = (1<<TWINT) | (1<<TWSTA) | (1<<TWEN);
 
 	/* Wait for TWINT flag set in TWCR Register (start bit is send successfully) */
-	while(BIT_IS_CLEAR(TWCR,TWINT));
+	TWI_wait();
 }
 
 /*
@@ -74,7 +253,7 @@ void TWI_stop(void)
 	 * send the stop bit by TWSTO=1
 	 * Enable TWI Module TWEN=1
 	 */
-	TWCR = (1<TWINT) | (1<<TWSTO) | (1<<TWEN);
+	TWCR = (1<<TWINT) | (1<<TWSTO) | (1<<TWEN);
 }
 
 /*
@@ -92,7 +271,7 @@ void TWI_writeByte(uint8 data)
 	 */
 	TWCR = (1 << TWINT) | (1 << TWEN);
 	/* Wait for TWINT flag set in TWCR Register(data is send successfully) */
-	while(BIT_IS_CLEAR(TWCR,TWINT));
+	TWI_wait();
 }
 
 /*
@@ -108,7 +287,7 @@ uint8 TWI_readByteWithACK(void)
 	 */
 	TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWEA);
 	/* Wait for TWINT flag set in TWCR Register (data received successfully) */
-	while(BIT_IS_CLEAR(TWCR,TWINT));
+	TWI_wait();
 	/* Read Data */
 	return TWDR;
 }
@@ -125,7 +304,7 @@ uint8 TWI_readByteWithNACK(void)
 	 */
 	TWCR = (1 << TWINT) | (1 << TWEN);
 	/* Wait for TWINT flag set in TWCR Register (data received successfully) */
-	while(BIT_IS_CLEAR(TWCR,TWINT));
+	TWI_wait();
 	/* Read Data */
 	return TWDR;
 }
@@ -141,3 +320,118 @@ uint8 TWI_getStatus(void)
 	status = (TWSR & 0xF8);
 	return status;
 }
+
+/*
+ * Description :
+ * Queues an asynchronous transaction run by the TWI ISR. Returns FALSE if the queue is full.
+ * Can be called from a call back (inside the ISR).
+ */
+uint8 TWI_submit(TWI_Transaction *transaction)
+{
+	uint8 sreg = SREG;
+	uint8 next;
+
+	cli();
+	next = (g_queueHead + 1) & (TWI_QUEUE_SIZE - 1);
+	if(next == g_queueTail)
+	{
+		SREG = sreg;
+		return FALSE;
+	}
+	transaction->Result = TWI_RESULT_PENDING;
+	g_queue[g_queueHead] = transaction;
+	g_queueHead = next;
+	if(next == ((g_queueTail + 1) & (TWI_QUEUE_SIZE - 1)))
+	{
+		/* Queue was empty: waits for the stop of the last transaction then sends the start */
+		g_lastEventMs = Timebase_getMs();
+		while(BIT_IS_SET(TWCR,TWSTO))
+		{
+			if((Timebase_getMs() - g_lastEventMs) >= TWI_TIMEOUT_MS)
+			{
+				++g_stats.Timeouts;
+				TWI_recover();
+				break;
+			}
+		}
+		TWCR = (1<<TWINT) | (1<<TWSTA) | (1<<TWEN) | (1<<TWIE);
+	}
+	SREG = sreg;
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Returns TRUE while asynchronous transactions are queued or running. Ends the running one with
+ * TWI_RESULT_TIMEOUT if the bus didn't move for TWI_TIMEOUT_MS ( the bus is recovered and the next
+ * queued transaction is started ).
+ */
+uint8 TWI_isBusy(void)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	if((g_queueHead != g_queueTail) && ((Timebase_getMs() - g_lastEventMs) >= TWI_TIMEOUT_MS))
+	{
+		++g_stats.Timeouts;
+		TWI_recover();
+		g_lastEventMs = Timebase_getMs();
+		TWI_complete(TWI_RESULT_TIMEOUT);
+	}
+	SREG = sreg;
+	return (g_queueHead != g_queueTail);
+}
+
+/*
+ * Description :
+ * Releases a stuck bus: the TWI is disabled, SCL is clocked ( open drain, the pins are driven low or
+ * released to the pull-ups ) until the slave releases SDA, a stop is sent and the TWI is enabled again
+ * with the same bit rate. Returns FALSE if SDA is still held low.
+ */
+uint8 TWI_recover(void)
+{
+	uint8 released;
+	uint8 i;
+
+	TWCR = 0;
+	CLEAR_BIT(PORTC,TWI_SCL_PIN);
+	CLEAR_BIT(PORTC,TWI_SDA_PIN);
+	CLEAR_BIT(DDRC,TWI_SDA_PIN);
+	for(i=0 ; (i < TWI_RECOVERY_CLOCKS) && BIT_IS_CLEAR(PINC,TWI_SDA_PIN) ; ++i)
+	{
+		SET_BIT(DDRC,TWI_SCL_PIN);					/* SCL low */
+		_delay_us(TWI_RECOVERY_HALF_US);
+		CLEAR_BIT(DDRC,TWI_SCL_PIN);				/* SCL released */
+		_delay_us(TWI_RECOVERY_HALF_US);
+	}
+	/* Stop: SDA rises while SCL is high */
+	SET_BIT(DDRC,TWI_SCL_PIN);
+	SET_BIT(DDRC,TWI_SDA_PIN);
+	_delay_us(TWI_RECOVERY_HALF_US);
+	CLEAR_BIT(DDRC,TWI_SCL_PIN);
+	_delay_us(TWI_RECOVERY_HALF_US);
+	CLEAR_BIT(DDRC,TWI_SDA_PIN);
+	_delay_us(TWI_RECOVERY_HALF_US);
+	released = BIT_IS_SET(PINC,TWI_SDA_PIN);
+
+	TWCR = (1<<TWEN);
+	++g_stats.Recoveries;
+	if(!released)
+	{
+		++g_stats.StuckBus;
+	}
+	return released;
+}
+
+/*
+ * Description :
+ * Copies the error counters.
+ */
+void TWI_getStats(TWI_Stats *stats)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	*stats = g_stats;
+	SREG = sreg;
+}
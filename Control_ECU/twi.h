@@ -21,6 +21,20 @@ Description : Header file for the TWI(I2C) AVR driver
 #define TWI_MT_DATA_ACK   0x28 /* Master transmit data and ACK has been received from Slave. */
 #define TWI_MR_DATA_ACK   0x50 /* Master received data and send ACK to slave. */
 #define TWI_MR_DATA_NACK  0x58 /* Master received data but doesn't send ACK to slave. */
+#define TWI_MT_SLA_W_NACK 0x20 /* Master transmit ( slave address + Write request ) to slave + NACK received from slave. */
+#define TWI_MT_DATA_NACK  0x30 /* Master transmit data and NACK has been received from Slave. */
+#define TWI_ARB_LOST      0x38 /* Arbitration lost in slave address or data bytes. */
+#define TWI_MR_SLA_R_NACK 0x48 /* Master transmit ( slave address + Read request ) to slave + NACK received from slave. */
+#define TWI_BUS_ERROR     0x00 /* Illegal start or stop condition. */
+#define TWI_NO_INFO       0xF8 /* No bus event, status of a wait that timed out ( the bus was recovered ). */
+
+#define TWI_QUEUE_SIZE	  4	   /* Queued asynchronous transactions ( Must be a power of 2 ) */
+
+/* Longest wait of a bus event ( a byte takes 25 us at 400 KHz ). When it expires the bus is recovered:
+ * SCL is clocked until the slave releases SDA, a stop is sent and the TWI is enabled again. A blocking
+ * wait then returns with TWI_NO_INFO status, an asynchronous transaction ends with TWI_RESULT_TIMEOUT.
+ * The Timebase must run ( 1 ms resolution, the wait lasts 1 to 2 ms ) */
+#define TWI_TIMEOUT_MS	  2
 
 /***************************************************************************************************
  *                                		Types Decelerations                                  	   *
@@ -44,6 +58,44 @@ typedef struct
 	TWI_Prescalar 	TWI_Prescalar;
 }TWI_ConfigType;
 
+/*	Result of an asynchronous transaction	*/
+typedef enum
+{
+	TWI_RESULT_OK, TWI_RESULT_PENDING, TWI_RESULT_ADDRESS_NACK, TWI_RESULT_DATA_NACK, TWI_RESULT_ARBITRATION,
+	TWI_RESULT_BUS_ERROR, TWI_RESULT_TIMEOUT
+}TWI_Result;
+
+/*	Error counters since TWI_init	*/
+typedef struct
+{
+	uint16	Timeouts;			/* Waits of a bus event that expired */
+	uint16	Recoveries;			/* Bus recoveries ( after a timeout or a bus error ) */
+	uint16	StuckBus;			/* Recoveries that couldn't release SDA */
+	uint16	BusErrors;			/* Illegal start / stop seen by the TWI */
+	uint16	ArbitrationLost;
+}TWI_Stats;
+
+/*	Descriptor of an asynchronous transaction, owned by the caller until the call back:
+ * 	1- Slave address byte with R/W=0 ( the read address is SlaveAddress | 1 )
+ * 	2- Up to 2 sub-address bytes sent first ( e.g. EEPROM memory location address )
+ * 	3- Bytes written after the sub-address ( 0 for none )
+ * 	4- Bytes read after a repeated start ( 0 for a write only transaction )
+ * 	5- Call back function called from the TWI ISR when the transaction ends ( NULL_PTR for none )
+ * 	6- Result, TWI_RESULT_PENDING until the transaction ends
+ */
+typedef struct TWI_Transaction
+{
+	uint8			SlaveAddress;
+	uint8			SubAddress[2];
+	uint8			SubAddressLength;
+	const uint8		*TxData;
+	uint16			TxLength;
+	uint8			*RxData;
+	uint16			RxLength;
+	void			(*CallBack)(struct TWI_Transaction *transaction);
+	volatile TWI_Result Result;
+}TWI_Transaction;
+
 /***************************************************************************************************
  *                                		Function Prototypes                                 	   *
  ***************************************************************************************************/
@@ -56,7 +108,7 @@ void TWI_init(const TWI_ConfigType* Config_Ptr);
 
 /*
  * Description :
- * Sends a TWI start bit.
+ * Sends a TWI start bit ( TWI_TIMEOUT_MS at most ).
  */
 void TWI_start(void);
 
@@ -68,19 +120,19 @@ void TWI_stop(void);
 
 /*
  * Description :
- * Write a byte and receive an ACK from selected slave.
+ * Write a byte and receive an ACK from selected slave ( TWI_TIMEOUT_MS at most ).
  */
 void TWI_writeByte(uint8 data);
 
 /*
  * Description :
- * Read a byte from slave and send ACK.
+ * Read a byte from slave and send ACK ( TWI_TIMEOUT_MS at most ).
  */
 uint8 TWI_readByteWithACK(void);
 
 /*
  * Description :
- * Read a byte from slave and send NACK.
+ * Read a byte from slave and send NACK ( TWI_TIMEOUT_MS at most ).
  */
 uint8 TWI_readByteWithNACK(void);
 
@@ -90,5 +142,32 @@ uint8 TWI_readByteWithNACK(void);
  */
 uint8 TWI_getStatus(void);
 
+/*
+ * Description :
+ * Queues an asynchronous transaction run by the TWI ISR. Returns FALSE if the queue is full.
+ * Global interrupts must be enabled. The blocking functions above must not be used while TWI_isBusy.
+ */
+uint8 TWI_submit(TWI_Transaction *transaction);
+
+/*
+ * Description :
+ * Returns TRUE while asynchronous transactions are queued or running. Ends the running one with
+ * TWI_RESULT_TIMEOUT if the bus didn't move for TWI_TIMEOUT_MS ( the bus is recovered ).
+ */
+uint8 TWI_isBusy(void);
+
+/*
+ * Description :
+ * Releases a stuck bus: clocks SCL until the slave releases SDA, sends a stop and enables the TWI again.
+ * Returns FALSE if SDA is still held low.
+ */
+uint8 TWI_recover(void);
+
+/*
+ * Description :
+ * Copies the error counters.
+ */
+void TWI_getStats(TWI_Stats *stats);
+
 
 #endif /* TWI_H_ */
@@ -7,7 +7,222 @@ Description : Source file for the UART AVR driver
 
 #include "uart.h"
 #include "common_macros.h"
+#include "timebase.h"			/* For the receive timeout */
 #include <avr/io.h>				/* To use the UART Registers */
+#include <avr/interrupt.h>		/* For the RXC and UDRE interrupts */
+#include <avr/pgmspace.h>		/* The baud table is kept in flash */
+
+/***************************************************************************************************
+ *                                		Types Decelerations                                  	   *
+ ***************************************************************************************************/
+
+/*	Baud rate and its UBRR value, UART_UBRR_INVALID if the rate isn't supported	*/
+typedef struct
+{
+	UART_BaudRate	BaudRate;
+	uint16			Ubrr;
+}UART_BaudEntry;
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+#define UART_UBRR_INVALID				0xFFFF
+#define UART_BAUD_ENTRY(baud)			{ (baud), ((UART_BAUD_IS_VALID(baud) && ((baud) <= UART_MAX_BAUD)) ? \
+										(uint16)UART_UBRR(baud) : UART_UBRR_INVALID) }
+#define UART_BAUD_COUNT					(sizeof(g_baudTable) / sizeof(g_baudTable[0]))
+
+/* Writes a byte to UDR and clears the TXC flag (written as one) so UART_flushTx waits for this byte.
+ * FE, DOR and PE must be written as zero, U2X and MPCM keep their values. */
+#define UART_WRITE_UDR(data)			do { UCSRA = (UCSRA & ((1<<U2X) | (1<<MPCM))) | (1<<TXC); \
+										UDR = (data); g_txStarted = TRUE; \
+										UART_TRACE_BYTE((data), UART_TRACE_TX | \
+										(BIT_IS_SET(UCSRB,TXB8) ? UART_TRACE_ADDRESS : 0)); } while(0)
+
+#if (UART_TRACE)
+#define UART_TRACE_BYTE(data, flags)	UART_traceByte((data), (flags))
+#else
+#define UART_TRACE_BYTE(data, flags)	do { } while(0)
+#endif
+
+/***************************************************************************************************
+ *                                		Global Variables                                    	   *
+ ***************************************************************************************************/
+
+/* All the rates of UART_BaudRate in order (bit n of the supported mask is entry n), UBRR values are
+ * computed by the compiler so changing the rate needs no division at run time. Kept in flash, a const
+ * table would be copied to SRAM at startup */
+static const UART_BaudEntry g_baudTable[] PROGMEM =
+{
+	UART_BAUD_ENTRY(Baud_2400),		UART_BAUD_ENTRY(Baud_4800),		UART_BAUD_ENTRY(Baud_9600),
+	UART_BAUD_ENTRY(Baud_14400),	UART_BAUD_ENTRY(Baud_19200),	UART_BAUD_ENTRY(Baud_28800),
+	UART_BAUD_ENTRY(Baud_38400),	UART_BAUD_ENTRY(Baud_57600),	UART_BAUD_ENTRY(Baud_76800),
+	UART_BAUD_ENTRY(Baud_115200),	UART_BAUD_ENTRY(Baud_230400),	UART_BAUD_ENTRY(Baud_250k),
+	UART_BAUD_ENTRY(Baud_500k),		UART_BAUD_ENTRY(Baud_1M)
+};
+
+/* Driver mode selected in UART_init */
+static UART_Mode g_uartMode = UART_POLLING_MODE;
+
+/* Global variable to hold the address of the receive call back function in the application */
+static void (*volatile g_rxCallBackPtr)(uint8) = NULL_PTR;
+
+/* RX ring buffer: written by the RXC ISR (head) and read by the application (tail) */
+static volatile uint8 g_rxBuffer[UART_RX_BUFFER_SIZE];
+static volatile uint8 g_rxHead = 0;
+static volatile uint8 g_rxTail = 0;
+
+/* TX ring buffer: written by the application (head) and read by the UDRE ISR (tail) */
+static volatile uint8 g_txBuffer[UART_TX_BUFFER_SIZE];
+static volatile uint8 g_txHead = 0;
+static volatile uint8 g_txTail = 0;
+
+/* TRUE once a byte is written to UDR, TXC is only meaningful after that */
+static volatile uint8 g_txStarted = FALSE;
+
+/* Address of this node on the MPCM bus, UART_NO_ADDRESS on a point to point link */
+static volatile uint8 g_nodeAddress = UART_NO_ADDRESS;
+
+#if (UART_TRACE)
+/* Trace buffer: written by the ISRs and the sending code (head), read by the dump (tail) */
+static UART_TraceEntry g_traceBuffer[UART_TRACE_SIZE];
+static uint8 g_traceHead = 0;
+static uint8 g_traceTail = 0;
+static uint16 g_traceLost = 0;
+static uint8 g_traceEnabled = TRUE;
+#endif
+
+/***************************************************************************************************
+ *                                	Interrupt Service Routine                                      *
+ ***************************************************************************************************/
+
+#if (UART_TRACE)
+/*	Records a sent or received byte, the oldest entry is overwritten if the buffer is full	*/
+static void UART_traceByte(uint8 data, uint8 flags)
+{
+	UART_TraceEntry *entry;
+	uint8 sreg;
+
+	if(!g_traceEnabled)
+	{
+		return;
+	}
+
+	/* Both the RXC ISR and the sending code record bytes */
+	sreg = SREG;
+	cli();
+	entry = &g_traceBuffer[g_traceHead];
+	entry->time = (uint16)Timebase_getMs();
+	entry->flags = flags;
+	entry->data = data;
+	g_traceHead = (g_traceHead + 1) & (UART_TRACE_SIZE - 1);
+	if(g_traceHead == g_traceTail)
+	{
+		g_traceTail = (g_traceTail + 1) & (UART_TRACE_SIZE - 1);
+		++g_traceLost;
+	}
+	SREG = sreg;
+}
+#endif
+
+/* Rate and UBRR of an entry of the baud table in flash */
+static UART_BaudRate UART_entryBaud(uint8 i)
+{
+	return (UART_BaudRate)pgm_read_dword(&g_baudTable[i].BaudRate);
+}
+
+static uint16 UART_entryUbrr(uint8 i)
+{
+	return pgm_read_word(&g_baudTable[i].Ubrr);
+}
+
+/*	Writes the baud rate register, first 8 bits inside UBRRL and last 4 bits in UBRRH	*/
+static void UART_writeUbrr(uint16 ubrr)
+{
+	/* URSEL = 0 to write on UBRRH shared register*/
+	UBRRH = (uint8)(ubrr>>8) & ~(1<<URSEL);
+	UBRRL = (uint8)ubrr;
+}
+
+/*
+ * A node of the MPCM bus that isn't addressed mustn't drive the shared line: the queued bytes are dropped
+ * and the transmitter is disabled ( after the byte in the shift register ) so TXD is released
+ */
+static void UART_releaseBus(void)
+{
+	CLEAR_BIT(UCSRB,UDRIE);
+	g_txTail = g_txHead;
+	CLEAR_BIT(UCSRB,TXEN);
+}
+
+/*
+ * Receive complete: hand the byte from UDR to the call back function if one is set, otherwise move it
+ * to the RX ring buffer (dropped if the buffer is full)
+ */
+static void UART_rxService(void)
+{
+	uint8 addressFrame = BIT_IS_SET(UCSRB,RXB8);		/* 9th bit must be read before UDR */
+	uint8 data = UDR;
+	uint8 next;
+
+	UART_TRACE_BYTE(data, addressFrame ? UART_TRACE_ADDRESS : 0);
+
+	if((g_nodeAddress != UART_NO_ADDRESS) && addressFrame)
+	{
+		if(data == g_nodeAddress)
+		{
+			/* MPCM = 0: receive the data frames sent to this node (FE, DOR and PE written as zero),
+			 * it may answer on the line until another node is addressed */
+			UCSRA = UCSRA & (1<<U2X);
+			SET_BIT(UCSRB,TXEN);
+		}
+		else if(BIT_IS_CLEAR(UCSRA,MPCM))
+		{
+			/* Another node is addressed: skip its data frames and wait at the start rate */
+			UCSRA = (UCSRA & (1<<U2X)) | (1<<MPCM);
+			UART_releaseBus();
+			UART_writeUbrr(UART_UBRR(UART_START_BAUD));
+		}
+		return;
+	}
+
+	if(g_rxCallBackPtr != NULL_PTR)
+	{
+		(*g_rxCallBackPtr)(data);
+		return;
+	}
+
+	next = (g_rxHead + 1) & (UART_RX_BUFFER_SIZE - 1);
+	if(next != g_rxTail)
+	{
+		g_rxBuffer[g_rxHead] = data;
+		g_rxHead = next;
+	}
+}
+
+ISR(USART_RXC_vect)
+{
+	UART_rxService();
+}
+
+/*	Data register empty: send the next queued byte or stop the interrupt if nothing is left ( or this node
+ * of the MPCM bus isn't addressed ) */
+ISR(USART_UDRE_vect)
+{
+	if(!UART_isAddressed())
+	{
+		UART_releaseBus();
+	}
+	else if(g_txHead != g_txTail)
+	{
+		UART_WRITE_UDR(g_txBuffer[g_txTail]);
+		g_txTail = (g_txTail + 1) & (UART_TX_BUFFER_SIZE - 1);
+	}
+	else
+	{
+		CLEAR_BIT(UCSRB,UDRIE);
+	}
+}
 
 /***************************************************************************************************
  *                                		Function Definitions                                  	   *
@@ -18,10 +233,24 @@ Description : Source file for the UART AVR driver
  * Functional responsible for Initializing the UART device by:
  * 1. Setup the Frame format like number of data bits, parity bit type and number of stop bits.
  * 2. Enable the UART.
- * 3. Setup the UART baud rate.
+ * 3. Setup the UART baud rate, check it with UART_BAUD_ASSERT where it is configured ( the UART stays
+ *    disabled if the rate is not supported ).
  */
 void UART_init(const UART_ConfigType* Config_Ptr)
 {
+	/* Empty both ring buffers before setting the rate (nothing is waiting to be sent) */
+	g_uartMode = Config_Ptr->Mode;
+	g_rxHead = g_rxTail = 0;
+	g_txHead = g_txTail = 0;
+
+	/* UBRR from the table computed at build time. A rate out of tolerance is a build error with
+	 * UART_BAUD_ASSERT, it never falls back to another rate */
+	UCSRB = 0;
+	if(!UART_setBaudRate(Config_Ptr->BaudRate))
+	{
+		return;
+	}
+
 	/* U2X = 1 for double transmission speed */
 	SET_BIT(UCSRA,U2X);
 
@@ -34,24 +263,257 @@ void UART_init(const UART_ConfigType* Config_Ptr)
 	SET_BIT(UCSRC,URSEL);
 	UCSRC = (UCSRC & 0xCF) | ((Config_Ptr->ParityMode)<<UPM0);
 	UCSRC = (UCSRC & 0xF7) | ((Config_Ptr->StopBits)<<USBS);
-	UCSRC = (UCSRC & 0xF9) | ((Config_Ptr->DataBits)<<UCSZ0);
+	UCSRC = (UCSRC & 0xF9) | (((Config_Ptr->DataBits) & 0x03)<<UCSZ0);
+	/* UCSZ2 = 1 for 9 data bits ( its value is in UCSRB ) */
+	UCSRB = (UCSRB & ~(1<<UCSZ2)) | ((((Config_Ptr->DataBits) & 0x04) >> 2)<<UCSZ2);
 
-	/* URSEL = 0 to write on UBRRH shared register*/
-	CLEAR_BIT(UBRRH,URSEL);
-	/* Calculate the UBRR register value */
-	uint16 Baudrate_value = (uint16)(((F_CPU/((Config_Ptr->BaudRate) * 8UL)))-1);
-	/* First 8 bits from the BAUD_PRESCALE inside UBRRL and last 4 bits in UBRRH*/
-	UBRRH = (Baudrate_value>>8);
-	UBRRL = Baudrate_value;
+	/* Enable the receive interrupt in interrupt mode */
+	if(g_uartMode == UART_INTERRUPT_MODE)
+	{
+		SET_BIT(UCSRB,RXCIE);
+	}
+	else
+	{
+		CLEAR_BIT(UCSRB,RXCIE);
+		CLEAR_BIT(UCSRB,UDRIE);
+	}
+}
+
+/*
+ * Description :
+ * Changes the baud rate after all queued bytes are sent. UBRR comes from a table computed at build time.
+ * Returns FALSE (rate not changed) if the rate is out of tolerance or above UART_MAX_BAUD.
+ */
+uint8 UART_setBaudRate(UART_BaudRate baud)
+{
+	uint8 i;
+
+	for(i=0 ; i<UART_BAUD_COUNT ; ++i)
+	{
+		if((UART_entryBaud(i) == baud) && (UART_entryUbrr(i) != UART_UBRR_INVALID))
+		{
+			/* The rate of the bytes still in the shift register must not change */
+			UART_flushTx();
+			UART_writeUbrr(UART_entryUbrr(i));
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/*
+ * Description :
+ * Returns the baud rates this ECU supports as a mask, bit n is the n-th rate of UART_BaudRate.
+ */
+uint16 UART_getSupportedBauds(void)
+{
+	uint16 mask = 0;
+	uint8 i;
+
+	for(i=0 ; i<UART_BAUD_COUNT ; ++i)
+	{
+		if(UART_entryUbrr(i) != UART_UBRR_INVALID)
+		{
+			mask |= (1<<i);
+		}
+	}
+	return mask;
+}
+
+/*
+ * Description :
+ * Returns the highest baud rate in a mask of UART_getSupportedBauds, UART_START_BAUD if it is empty.
+ */
+UART_BaudRate UART_getHighestBaud(uint16 mask)
+{
+	uint8 i = UART_BAUD_COUNT;
 
+	mask &= UART_getSupportedBauds();
+	while(i > 0)
+	{
+		--i;
+		if(mask & (1<<i))
+		{
+			return UART_entryBaud(i);
+		}
+	}
+	return UART_START_BAUD;
 }
 
+/*
+ * Description :
+ * Returns the next higher supported baud rate, after the highest one it wraps to the lowest one.
+ */
+UART_BaudRate UART_getNextBaud(UART_BaudRate baud)
+{
+	uint8 i;
+
+	/* First supported rate above the current one */
+	for(i=0 ; i<UART_BAUD_COUNT ; ++i)
+	{
+		if((UART_entryBaud(i) > baud) && (UART_entryUbrr(i) != UART_UBRR_INVALID))
+		{
+			return UART_entryBaud(i);
+		}
+	}
+	/* Wraps to the lowest supported rate */
+	for(i=0 ; i<UART_BAUD_COUNT ; ++i)
+	{
+		if(UART_entryUbrr(i) != UART_UBRR_INVALID)
+		{
+			break;
+		}
+	}
+	return UART_entryBaud(i);
+}
+
+/*
+ * Description :
+ * Blocks until all the queued bytes and the byte in the shift register are sent.
+ */
+void UART_flushTx(void)
+{
+	/* Sends the queued bytes (by polling if the UDRE interrupt can't run) */
+	while(g_txHead != g_txTail)
+	{
+		if(BIT_IS_CLEAR(SREG,SREG_I) && BIT_IS_SET(UCSRA,UDRE))
+		{
+			UART_WRITE_UDR(g_txBuffer[g_txTail]);
+			g_txTail = (g_txTail + 1) & (UART_TX_BUFFER_SIZE - 1);
+		}
+	}
+	/* TXC is cleared with every byte written to UDR and set when the shift register is empty */
+	if(g_txStarted)
+	{
+		while(BIT_IS_CLEAR(UCSRA,UDRE) || BIT_IS_CLEAR(UCSRA,TXC)){}
+	}
+}
+
+/*
+ * Description :
+ * Makes this UART a node of the MPCM bus (Interrupt mode with Data_9 only): received bytes are ignored
+ * until an address frame with this address arrives, and again after an address frame of another node
+ * (the baud rate goes back to UART_START_BAUD then). Nothing is sent while it isn't addressed. Pass
+ * UART_NO_ADDRESS to leave the bus mode.
+ */
+void UART_setNodeAddress(uint8 address)
+{
+	g_nodeAddress = address;
+	if(address == UART_NO_ADDRESS)
+	{
+		UCSRA = UCSRA & (1<<U2X);						/* MPCM = 0 */
+		SET_BIT(UCSRB,TXEN);
+	}
+	else
+	{
+		/* MPCM = 1: only address frames raise RXC until this node is addressed, TXD released till then */
+		UCSRA = (UCSRA & (1<<U2X)) | (1<<MPCM);
+		UART_releaseBus();
+	}
+}
+
+/*
+ * Description :
+ * Returns TRUE if this UART may send: point to point link, or node of the MPCM bus addressed by the
+ * master. Bytes sent while it isn't addressed are dropped.
+ */
+uint8 UART_isAddressed(void)
+{
+	return (g_nodeAddress == UART_NO_ADDRESS) || BIT_IS_CLEAR(UCSRA,MPCM);
+}
+
+/*
+ * Description :
+ * Sends an address frame (9th bit = 1) on the MPCM bus (Data_9 only) after the queued data bytes.
+ * The addressed node receives the next data bytes and the previous one goes back to ignoring them.
+ */
+void UART_sendAddress(uint8 address)
+{
+	/* TXB8 is copied with UDR to the shift register, so the data bytes must all be sent first */
+	UART_flushTx();
+	SET_BIT(UCSRB,TXB8);
+	UART_WRITE_UDR(address);
+	/* The shift register was empty, UDRE is set again as soon as the address frame moved to it */
+	while (BIT_IS_CLEAR(UCSRA,UDRE)){}
+	CLEAR_BIT(UCSRB,TXB8);
+}
+
+#if (UART_TRACE)
+/*
+ * Description :
+ * Starts (TRUE) or pauses (FALSE) recording the link bytes, paused while the trace itself is sent.
+ */
+void UART_traceEnable(uint8 enable)
+{
+	g_traceEnabled = enable;
+}
+
+/*
+ * Description :
+ * Takes the oldest trace entry out of the buffer. Returns FALSE if the buffer is empty.
+ */
+uint8 UART_traceRead(UART_TraceEntry *entry)
+{
+	uint8 sreg = SREG;
+	uint8 found = FALSE;
+
+	cli();
+	if(g_traceHead != g_traceTail)
+	{
+		*entry = g_traceBuffer[g_traceTail];
+		g_traceTail = (g_traceTail + 1) & (UART_TRACE_SIZE - 1);
+		found = TRUE;
+	}
+	SREG = sreg;
+	return found;
+}
+
+/*
+ * Description :
+ * Returns the number of entries overwritten since the last call (buffer was full) and clears it.
+ */
+uint16 UART_traceLost(void)
+{
+	uint16 lost;
+	uint8 sreg = SREG;
+
+	cli();
+	lost = g_traceLost;
+	g_traceLost = 0;
+	SREG = sreg;
+	return lost;
+}
+#endif
+
 /*
  * Description :
  * Functional responsible for send byte to another UART device.
+ * Blocks until the byte is accepted by the UDR register or the TX ring buffer.
  */
 void UART_sendByte(const uint8 data)
 {
+	if(!UART_isAddressed())
+	{
+		return;									/* Not addressed on the MPCM bus, dropped */
+	}
+	if((g_uartMode == UART_INTERRUPT_MODE) && BIT_IS_SET(SREG,SREG_I))
+	{
+		/* Wait for room in the TX ring buffer, the UDRE ISR drains it in the background */
+		while(!UART_queueSend(data)){}
+		return;
+	}
+
+	/*
+	 * Interrupts are disabled (Polling mode or called from another ISR) so the UDRE ISR can't run.
+	 * Send any queued bytes first to keep the order, then send this byte directly.
+	 */
+	while(g_txHead != g_txTail)
+	{
+		while (BIT_IS_CLEAR(UCSRA,UDRE)){}
+		UART_WRITE_UDR(g_txBuffer[g_txTail]);
+		g_txTail = (g_txTail + 1) & (UART_TX_BUFFER_SIZE - 1);
+	}
+
 	/*
 	 * UDRE flag is set when the TX buffer (UDR) is empty and ready for
 	 * transmitting a new byte so wait until this flag is set to one
@@ -62,7 +524,7 @@ void UART_sendByte(const uint8 data)
 	 * Put the required data in the UDR register and it also clear the UDRE flag as
 	 * the UDR register is not empty now
 	 */
-	UDR = data;
+	UART_WRITE_UDR(data);
 
 	/************************* Another Method *************************
 	UDR = data;
@@ -74,9 +536,22 @@ void UART_sendByte(const uint8 data)
 /*
  * Description :
  * Functional responsible for receive byte from another UART device.
+ * Blocks until a byte is available in the UDR register or the RX ring buffer.
  */
 uint8 UART_receiveByte(void)
 {
+	uint8 data;
+
+	if(g_uartMode == UART_INTERRUPT_MODE)
+	{
+		/* Wait until the RXC ISR puts a byte in the RX ring buffer */
+		while(!UART_tryReceive(&data))
+		{
+			UART_rxPoll();
+		}
+		return data;
+	}
+
 	/* RXC flag is set when the UART receive data so wait until this flag is set to one */
 	while (BIT_IS_CLEAR(UCSRA,RXC)){}
 
@@ -87,6 +562,115 @@ uint8 UART_receiveByte(void)
 	return UDR;
 }
 
+/*
+ * Description :
+ * Functional responsible for receive byte from another UART device within timeout_ms milliseconds.
+ * Returns TRUE and stores the byte in data if it arrived in time, FALSE if the timeout expired.
+ * Needs the time base (Timebase_init) to be running.
+ */
+uint8 UART_receiveByteTimeout(uint16 timeout_ms, uint8 *data)
+{
+	uint32 start = Timebase_getMs();
+
+	do
+	{
+		if(UART_tryReceive(data))
+		{
+			return TRUE;
+		}
+		UART_rxPoll();
+	}while((Timebase_getMs() - start) < timeout_ms);
+
+	return FALSE;
+}
+
+/*
+ * Description :
+ * Non-blocking send. Queues the byte in the TX ring buffer (Interrupt mode) or writes it to UDR
+ * if the transmitter is free (Polling mode).
+ * Returns TRUE if the byte is accepted, FALSE if there is no room for it now.
+ */
+uint8 UART_queueSend(const uint8 data)
+{
+	uint8 next;
+
+	if(!UART_isAddressed())
+	{
+		return TRUE;							/* Not addressed on the MPCM bus, dropped */
+	}
+	if(g_uartMode == UART_POLLING_MODE)
+	{
+		if(BIT_IS_CLEAR(UCSRA,UDRE))
+		{
+			return FALSE;
+		}
+		UART_WRITE_UDR(data);
+		return TRUE;
+	}
+
+	next = (g_txHead + 1) & (UART_TX_BUFFER_SIZE - 1);
+	if(next == g_txTail)
+	{
+		return FALSE;							/* TX ring buffer is full */
+	}
+	g_txBuffer[g_txHead] = data;
+	g_txHead = next;
+
+	/* Enable the UDRE interrupt to start sending (it disables itself when the buffer is empty) */
+	SET_BIT(UCSRB,UDRIE);
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Non-blocking receive. Takes the oldest byte from the RX ring buffer (Interrupt mode) or from UDR
+ * if a byte has arrived (Polling mode).
+ * Returns TRUE and stores the byte in data if one is available, FALSE otherwise.
+ */
+uint8 UART_tryReceive(uint8 *data)
+{
+	if(g_uartMode == UART_POLLING_MODE)
+	{
+		if(BIT_IS_CLEAR(UCSRA,RXC))
+		{
+			return FALSE;
+		}
+		*data = UDR;
+		return TRUE;
+	}
+
+	if(g_rxHead == g_rxTail)
+	{
+		return FALSE;							/* RX ring buffer is empty */
+	}
+	*data = g_rxBuffer[g_rxTail];
+	g_rxTail = (g_rxTail + 1) & (UART_RX_BUFFER_SIZE - 1);
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Services a received byte by polling when the RXC interrupt can't run because the global interrupts
+ * are disabled (called from inside another ISR). Does nothing in any other case.
+ */
+void UART_rxPoll(void)
+{
+	if((g_uartMode == UART_INTERRUPT_MODE) && BIT_IS_CLEAR(SREG,SREG_I) && BIT_IS_SET(UCSRA,RXC))
+	{
+		UART_rxService();
+	}
+}
+
+/*
+ * Description: Function to set the receive Call Back function address (Interrupt mode only).
+ * Each received byte is passed to the call back from the RXC ISR instead of the RX ring buffer.
+ * Pass NULL_PTR to go back to the RX ring buffer.
+ */
+void UART_setRxCallBack(void(*a_ptr)(uint8))
+{
+	g_rxCallBackPtr = a_ptr;
+}
+
 /*
  * Description :
  * Send the required string through UART to the other UART device.
@@ -0,0 +1,427 @@
+/******************************************************************************************************
+File Name	: user_table.c
+Author		: Sherif Beshr
+Description : Source file for the multi-user PIN table. Only the salted digest of every PIN is saved
+			  ( one salt in the header of the table ). The slots in the External EEPROM are read once at
+			  boot to build the SRAM index: the first 8 bits of every digest with its slot, sorted. A PIN
+			  is verified by its digest, a binary search of its first 8 bits then one slot read to compare
+			  the whole digest in constant time, so the time doesn't depend on the number of users ( no
+			  linear scan of the EEPROM ). The digests are keyed by the device secret, an index hit
+			  doesn't tell anything about the digits.
+*******************************************************************************************************/
+
+#include "user_table.h"
+#include "external_eeprom.h"
+#include "crc.h"
+
+#ifndef USERS_EEPROM_SIZE
+#define USERS_EEPROM_SIZE		2048		/* 24C16 */
+#endif
+#if ((USERS_TABLE_ADDRESS + (USERS_MAX + 1) * USERS_SLOT_SIZE) > USERS_EEPROM_SIZE)
+#error "The user table doesn't fit in the EEPROM"
+#endif
+#if (USERS_SLOT_SIZE != EEPROM_PAGE_SIZE)
+#error "A slot is written in one page write"
+#endif
+#if ((DIGEST_SALT_SIZE + 3) > USERS_SLOT_SIZE) || ((DIGEST_SIZE + 4) > USERS_SLOT_SIZE)
+#error "The header and the slots are one page each"
+#endif
+
+/***************************************************************************************************
+ *                                		Types Decelerations                                  	   *
+ ***************************************************************************************************/
+
+/*	Entry of the SRAM index: 2 bytes per user on the ECU ( 1 KB SRAM ), the first 8 bits of the digest tell
+ * a wrong PIN 255 times out of 256 without a slot read. Bigger tables ( host benchmark ) use 16 bits */
+#if (USERS_MAX > 255)
+typedef uint16 USERS_Key;
+#else
+typedef uint8 USERS_Key;
+#endif
+
+typedef struct
+{
+	USERS_Key	Hash;			/* First bits of the PIN digest */
+	USERS_Key	Slot;
+}USERS_IndexEntry;
+
+/***************************************************************************************************
+ *                                		Global Variables                                    	   *
+ ***************************************************************************************************/
+
+static USERS_IndexEntry g_index[USERS_MAX];		/* Sorted by Hash */
+static uint16 g_count = 0;
+static uint8 g_used[(USERS_MAX + 7) / 8];		/* Bit per slot, set if it holds a user */
+static USERS_Slot g_slot;						/* Last slot read / written */
+static uint8 g_salt[DIGEST_SALT_SIZE];			/* Salt of the table ( header ) */
+static uint8 g_loaded = FALSE;					/* TRUE once the header and all the slots were read */
+static USERS_Stats g_stats;
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Returns the EEPROM address of a slot.
+ */
+static uint16 USERS_slotAddress(uint16 slot)
+{
+	return USERS_TABLE_ADDRESS + (slot + 1) * USERS_SLOT_SIZE;		/* After the header */
+}
+
+/*
+ * Description :
+ * Returns TRUE if g_slot holds a valid user.
+ */
+static uint8 USERS_isValidSlot(void)
+{
+	return (g_slot.Status == USERS_SLOT_USED) && (g_slot.UserId != USERS_NO_USER) &&
+			(g_slot.Crc == CRC_8((const uint8 *)&g_slot, sizeof(USERS_Slot) - 1));
+}
+
+/*
+ * Description :
+ * Reads a slot in g_slot. Returns TRUE if it holds a valid user.
+ */
+static uint8 USERS_readSlot(uint16 slot)
+{
+	return (EEPROM_readBlock(USERS_slotAddress(slot), (uint8 *)&g_slot, sizeof(USERS_Slot)) == SUCCESS) &&
+			USERS_isValidSlot();
+}
+
+/*
+ * Description :
+ * Returns the position of the first index entry with a hash not lower than hash ( binary search ).
+ */
+static uint16 USERS_lowerBound(USERS_Key hash)
+{
+	uint16 low = 0;
+	uint16 high = g_count;
+	uint16 middle;
+
+	while(low < high)
+	{
+		middle = (low + high) / 2;
+		++g_stats.Probes;
+		if(g_index[middle].Hash < hash)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	return low;
+}
+
+/*
+ * Description :
+ * Adds a slot to the index keeping it sorted.
+ */
+static void USERS_insertIndex(USERS_Key hash, uint16 slot)
+{
+	uint16 position = USERS_lowerBound(hash);
+	uint16 i;
+
+	for(i=g_count ; i>position ; --i)
+	{
+		g_index[i] = g_index[i - 1];
+	}
+	g_index[position].Hash = hash;
+	g_index[position].Slot = (USERS_Key)slot;
+	++g_count;
+	g_used[slot / 8] |= (1 << (slot % 8));
+}
+
+/*
+ * Description :
+ * Removes a slot from the index.
+ */
+static void USERS_removeIndex(uint16 slot)
+{
+	uint16 i;
+
+	for(i=0 ; (i < g_count) && (g_index[i].Slot != slot) ; ++i);
+	for( ; (i + 1) < g_count ; ++i)
+	{
+		g_index[i] = g_index[i + 1];
+	}
+	if(g_count > 0)
+	{
+		--g_count;
+	}
+	g_used[slot / 8] &= ~(1 << (slot % 8));
+}
+
+/*
+ * Description :
+ * Returns TRUE if the slot is used.
+ */
+static uint8 USERS_isUsed(uint16 slot)
+{
+	return (g_used[slot / 8] & (1 << (slot % 8))) != 0;
+}
+
+/*
+ * Description :
+ * Returns the index key of a digest: its first 8 ( or 16 ) bits.
+ */
+static USERS_Key USERS_hash(const uint8 *digest)
+{
+	return (USERS_Key)(digest[0] | ((uint16)digest[1] << 8));
+}
+
+/*
+ * Description :
+ * Looks the digest of a PIN up: binary search of its first bits, then the slots with the same bits are
+ * read to compare the whole digest in constant time. Returns TRUE with the user in g_slot if found.
+ */
+static uint8 USERS_find(const uint8 *digest)
+{
+	USERS_Key hash = USERS_hash(digest);
+	uint16 position = USERS_lowerBound(hash);
+
+	for( ; (position < g_count) && (g_index[position].Hash == hash) ; ++position)
+	{
+		++g_stats.SlotReads;
+		if(USERS_readSlot(g_index[position].Slot) && DIGEST_equal(g_slot.Digest, digest))
+		{
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/*
+ * Description :
+ * Loads the salt from the header. If the header was read and isn't valid ( new EEPROM, other layout ) a new
+ * salt is written and the slots are freed: digests of another salt can't be verified.
+ * Returns FALSE if the header or a slot to free can't be read ( bus error ), the table is left as it is then.
+ */
+static uint8 USERS_loadHeader(void)
+{
+	USERS_Header header;
+	uint16 slot;
+	uint8 status;
+	uint8 i;
+
+	if(EEPROM_readBlock(USERS_TABLE_ADDRESS, (uint8 *)&header, sizeof(USERS_Header)) != SUCCESS)
+	{
+		return FALSE;
+	}
+	if((header.Magic == USERS_MAGIC) && (header.Version == USERS_VERSION) &&
+			(header.Crc == CRC_8((const uint8 *)&header, sizeof(USERS_Header) - 1)))
+	{
+		for(i=0 ; i<DIGEST_SALT_SIZE ; ++i)
+		{
+			g_salt[i] = header.Salt[i];
+		}
+		return TRUE;
+	}
+
+	for(slot=0 ; slot<USERS_MAX ; ++slot)
+	{
+		if(EEPROM_readByte(USERS_slotAddress(slot), &status) != SUCCESS)
+		{
+			return FALSE;
+		}
+		if(status == USERS_SLOT_USED)
+		{
+			EEPROM_writeByte(USERS_slotAddress(slot), 0);
+		}
+	}
+	DIGEST_newSalt(g_salt);
+	header.Magic = USERS_MAGIC;
+	header.Version = USERS_VERSION;
+	for(i=0 ; i<DIGEST_SALT_SIZE ; ++i)
+	{
+		header.Salt[i] = g_salt[i];
+	}
+	header.Crc = CRC_8((const uint8 *)&header, sizeof(USERS_Header) - 1);
+	return (EEPROM_writePage(USERS_TABLE_ADDRESS, (const uint8 *)&header, sizeof(USERS_Header)) == SUCCESS);
+}
+
+/*
+ * Description :
+ * Reads the table once and builds the SRAM index, a table without a valid header is cleared with a new
+ * salt. If the EEPROM can't be read the table is left as it is, the other functions fail until a later
+ * call loads it ( USERS_isLoaded ). Returns the number of users.
+ */
+uint16 USERS_init(void)
+{
+	uint16 slot;
+
+	g_loaded = FALSE;
+	g_count = 0;
+	for(slot=0 ; slot<sizeof(g_used) ; ++slot)
+	{
+		g_used[slot] = 0;
+	}
+	if(!USERS_loadHeader())
+	{
+		return 0;
+	}
+	for(slot=0 ; slot<USERS_MAX ; ++slot)
+	{
+		if(EEPROM_readBlock(USERS_slotAddress(slot), (uint8 *)&g_slot, sizeof(USERS_Slot)) != SUCCESS)
+		{
+			/* A user missing from the index could be added twice or its slot given to another one */
+			g_count = 0;
+			return 0;
+		}
+		if(USERS_isValidSlot())
+		{
+			USERS_insertIndex(USERS_hash(g_slot.Digest), slot);
+		}
+	}
+	g_loaded = TRUE;
+	return g_count;
+}
+
+/*
+ * Description :
+ * Returns TRUE if the last USERS_init loaded the table. It isn't loaded again here so a PIN check always
+ * takes the same time, the application calls USERS_init again while it is idle.
+ */
+uint8 USERS_isLoaded(void)
+{
+	return g_loaded;
+}
+
+/*
+ * Description :
+ * Adds a user with the digest of its PIN in the first free slot ( one page write ). Returns USERS_OK,
+ * USERS_EXISTS ( ID or PIN already used ), USERS_FULL or USERS_ERROR ( also if a used slot can't be read ).
+ */
+uint8 USERS_add(uint16 user_id, const uint8 *pin, uint8 length)
+{
+	uint8 digest[DIGEST_SIZE];
+	uint16 slot;
+	uint16 free_slot = USERS_MAX;
+	uint8 i;
+
+	if((user_id == USERS_NO_USER) || (length == 0) || !USERS_isLoaded())
+	{
+		return USERS_ERROR;
+	}
+	DIGEST_compute(g_salt, pin, length, digest);
+	if(USERS_find(digest))
+	{
+		return USERS_EXISTS;
+	}
+	/* The ID isn't in the index, the used slots are read ( administration only ). A used slot that can't
+	 * be read could hold the same ID, nothing is added then */
+	for(slot=0 ; slot<USERS_MAX ; ++slot)
+	{
+		if(!USERS_isUsed(slot))
+		{
+			free_slot = (free_slot == USERS_MAX) ? slot : free_slot;
+		}
+		else if(!USERS_readSlot(slot))
+		{
+			return USERS_ERROR;
+		}
+		else if(g_slot.UserId == user_id)
+		{
+			return USERS_EXISTS;
+		}
+	}
+	if(free_slot == USERS_MAX)
+	{
+		return USERS_FULL;
+	}
+
+	g_slot.Status = USERS_SLOT_USED;
+	g_slot.UserId = user_id;
+	for(i=0 ; i<DIGEST_SIZE ; ++i)
+	{
+		g_slot.Digest[i] = digest[i];
+	}
+	g_slot.Crc = CRC_8((const uint8 *)&g_slot, sizeof(USERS_Slot) - 1);
+	if(EEPROM_writePage(USERS_slotAddress(free_slot), (const uint8 *)&g_slot, sizeof(USERS_Slot)) != SUCCESS)
+	{
+		return USERS_ERROR;
+	}
+	USERS_insertIndex(USERS_hash(digest), free_slot);
+	return USERS_OK;
+}
+
+/*
+ * Description :
+ * Removes a user, its slot status is cleared ( one byte write ). Returns USERS_OK, USERS_NOT_FOUND or
+ * USERS_ERROR ( also if a used slot can't be read ).
+ */
+uint8 USERS_remove(uint16 user_id)
+{
+	uint16 slot;
+
+	if(!USERS_isLoaded())
+	{
+		return USERS_ERROR;
+	}
+	for(slot=0 ; slot<USERS_MAX ; ++slot)
+	{
+		if(!USERS_isUsed(slot))
+		{
+			continue;
+		}
+		/* A used slot that can't be read could be the user, it isn't reported as not found */
+		if(!USERS_readSlot(slot))
+		{
+			return USERS_ERROR;
+		}
+		if(g_slot.UserId == user_id)
+		{
+			if(EEPROM_writeByte(USERS_slotAddress(slot), 0) != SUCCESS)
+			{
+				return USERS_ERROR;
+			}
+			USERS_removeIndex(slot);
+			return USERS_OK;
+		}
+	}
+	return USERS_NOT_FOUND;
+}
+
+/*
+ * Description :
+ * Looks the PIN up in the index ( binary search on its digest, one slot read to confirm in constant
+ * time ). Returns the user ID, USERS_NO_USER if no user has this PIN.
+ */
+uint16 USERS_verify(const uint8 *pin, uint8 length)
+{
+	uint8 digest[DIGEST_SIZE];
+
+	g_stats.Probes = 0;
+	g_stats.SlotReads = 0;
+	if((length == 0) || !USERS_isLoaded())
+	{
+		return USERS_NO_USER;
+	}
+	DIGEST_compute(g_salt, pin, length, digest);
+	if(!USERS_find(digest))
+	{
+		return USERS_NO_USER;
+	}
+	return g_slot.UserId;
+}
+
+/*
+ * Description :
+ * Returns the number of users.
+ */
+uint16 USERS_count(void)
+{
+	return g_count;
+}
+
+/*
+ * Description :
+ * Copies the counters of the last USERS_verify.
+ */
+void USERS_getStats(USERS_Stats *stats)
+{
+	*stats = g_stats;
+}
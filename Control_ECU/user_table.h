@@ -0,0 +1,130 @@
+/******************************************************************************************************
+File Name	: user_table.h
+Author		: Sherif Beshr
+Description : Header file for the multi-user PIN table in the External EEPROM with its SRAM index
+*******************************************************************************************************/
+
+#ifndef USER_TABLE_H_
+#define USER_TABLE_H_
+
+#include "std_types.h"
+#include "digest.h"
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+/* Table of fixed size slots ( one EEPROM page each ) in the second 1 KB of the 24C16, after the log of
+ * the credential store: a header page then USERS_MAX users ( up to 63 fit the 1 KB ). USERS_MAX sets the
+ * SRAM used ( 2 bytes per user in the index, a bit in the used slots map ), 31 keeps room for the stack
+ * and the link trace in the 1 KB SRAM of the ATmega16 */
+#ifndef USERS_MAX
+#define USERS_MAX				31
+#endif
+#define USERS_TABLE_ADDRESS		0x0400		/* Header, the slots follow */
+#define USERS_SLOT_SIZE			16
+#define USERS_SLOT_USED			0xA5		/* Status of a slot holding a user, anything else is free */
+#define USERS_MAGIC				0x5A		/* First byte of the header */
+#define USERS_VERSION			2			/* Table layout version, the table is cleared if it differs */
+#define USERS_NO_USER			0			/* User ID 0 isn't valid */
+
+/* Results ( USER_RESULT frame ) */
+#define USERS_OK				0
+#define USERS_NOT_FOUND			1
+#define USERS_EXISTS			2
+#define USERS_FULL				3
+#define USERS_ERROR				4
+#define USERS_DENIED			5			/* Not in an admin session */
+
+/***************************************************************************************************
+ *                                		Types Decelerations                                  	   *
+ ***************************************************************************************************/
+
+/*	Header of the table:
+ * 	1- USERS_MAGIC
+ * 	2- USERS_VERSION
+ * 	3- Salt of the PIN digests of the table ( one per table so a PIN has one digest to look up )
+ * 	4- CRC-8 of the fields above
+ */
+typedef struct
+{
+	uint8	Magic;
+	uint8	Version;
+	uint8	Salt[DIGEST_SALT_SIZE];
+	uint8	Crc;
+}USERS_Header;
+
+/*	Slot of the table:
+ * 	1- USERS_SLOT_USED if the slot holds a user
+ * 	2- User ID ( 1 .. 65535 )
+ * 	3- Salted digest of the PIN digits ( the digits aren't saved )
+ * 	4- CRC-8 of the fields above
+ */
+typedef struct
+{
+	uint8	Status;
+	uint16	UserId;
+	uint8	Digest[DIGEST_SIZE];
+	uint8	Crc;
+}USERS_Slot;
+
+/*	Counters of the last USERS_verify, to compare the index with a linear scan of the table	*/
+typedef struct
+{
+	uint8	Probes;				/* Index entries compared by the binary search */
+	uint8	SlotReads;			/* Slots read from the EEPROM to confirm a digest match */
+}USERS_Stats;
+
+/***************************************************************************************************
+ *                                		Function Prototypes                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Reads the table once and builds the SRAM index, a table without a valid header is cleared with a new
+ * salt. If the EEPROM can't be read ( bus error ) nothing is changed and 0 is returned: USERS_add /
+ * USERS_remove return USERS_ERROR and USERS_verify USERS_NO_USER at once until a later call loads it.
+ * Returns the number of users.
+ */
+uint16 USERS_init(void);
+
+/*
+ * Description :
+ * Returns TRUE if the last USERS_init loaded the table ( call it again while idle if it didn't ).
+ */
+uint8 USERS_isLoaded(void);
+
+/*
+ * Description :
+ * Adds a user with its PIN. Returns USERS_OK, USERS_EXISTS ( ID or PIN already used ), USERS_FULL or
+ * USERS_ERROR ( also if a used slot can't be read ).
+ */
+uint8 USERS_add(uint16 user_id, const uint8 *pin, uint8 length);
+
+/*
+ * Description :
+ * Removes a user. Returns USERS_OK, USERS_NOT_FOUND or USERS_ERROR ( also if a used slot can't be read ).
+ */
+uint8 USERS_remove(uint16 user_id);
+
+/*
+ * Description :
+ * Looks the PIN up in the index ( binary search on its digest, one slot read to confirm in constant
+ * time ).
+ * Returns the user ID, USERS_NO_USER if no user has this PIN.
+ */
+uint16 USERS_verify(const uint8 *pin, uint8 length);
+
+/*
+ * Description :
+ * Returns the number of users.
+ */
+uint16 USERS_count(void);
+
+/*
+ * Description :
+ * Copies the counters of the last USERS_verify.
+ */
+void USERS_getStats(USERS_Stats *stats);
+
+#endif /* USER_TABLE_H_ */
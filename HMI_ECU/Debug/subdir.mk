@@ -5,25 +5,37 @@
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
 ../HMI_ECU.c \
+../event_queue.c \
+../frame.c \
 ../gpio.c \
 ../keypad.c \
 ../lcd.c \
+../link.c \
+../timebase.c \
 ../timer.c \
 ../uart.c 
 
 OBJS += \
 ./HMI_ECU.o \
+./event_queue.o \
+./frame.o \
 ./gpio.o \
 ./keypad.o \
 ./lcd.o \
+./link.o \
+./timebase.o \
 ./timer.o \
 ./uart.o 
 
 C_DEPS += \
 ./HMI_ECU.d \
+./event_queue.d \
+./frame.d \
 ./gpio.d \
 ./keypad.d \
 ./lcd.d \
+./link.d \
+./timebase.d \
 ./timer.d \
 ./uart.d 
 
@@ -8,11 +8,19 @@
 /********************************************GLOBAL VARIABLES*********************************************/
 
 volatile static uint8 g_OpenDoorTick = 0;
-volatile static uint8 g_BuzzerTick = 0;
 volatile static uint8 g_Timer_Flag = 0;
+volatile static uint8 g_Link_Error = 0;
 static uint8 g_FirstTime_flag = 0;
+static Timer_SoftTimer g_DoorTimer;								/* Door opening, keeping still and closing */
+static Timer_SoftTimer g_AlertTimer;							/* ALERT minute */
+static Timer_SoftTimer g_AlertCountTimer;						/* ALERT seconds left on the LCD */
+static uint8 g_AlertSeconds = 0;
 uint8 pass_matching = PASS_UNMATCH;
 uint8 g_fail_count = MAX_FAIL_TRIALS;
+#if (UART_MPCM_BUS)
+static uint8 g_DoorNode = 1;									/* Address of the selected door on the bus */
+static uint8 g_DoorFailCount[HMI_MAX_DOORS] = { [0 ... (HMI_MAX_DOORS - 1)] = MAX_FAIL_TRIALS };
+#endif
 
 
 
@@ -24,39 +32,43 @@ int main (void)
 	/* LCD Initialization on PORTB */
 	LCD_init();
 
-	/* Timer 1 Configurations to count 15 seconds
-	 * time per cycle = 8MHz / 1024 = 128uS
-	 * Cycles for 15 seconds = 15 / 0.000128 = 117,188 cycles
-	 * 117,188 / 2 = 58594 (On two Cycles with compare mode)
-	 */
-	Timer_ConfigType Timer1;
-	Timer1.Compare_value = 58594;
-	Timer1.Start_value = 0;
-	Timer1.Timer_Source = TIMER1_PRESCALAR_1024;
-	Timer1.Timer_mode = TIMER_COMPARE_MODE;
-	Timer1.Timerx_ID = TIMER1_ID;
-
 	/*UART Initialization
-	 * 1- Baud Rate : 9600
-	 * 2- Data Bits : 8
+	 * 1- Baud Rate : 9600 (UART_START_BAUD, stepped up after the handshake)
+	 * 2- Data Bits : 8 (9 on the MPCM bus)
 	 * 3- Parity	: Disable
 	 * 4- Stop Bits : 1
+	 * 5- Mode		: Interrupt driven (bytes are buffered while LCD/keypad work is running)
 	 */
 	UART_ConfigType UART_Config;
-	UART_Config.BaudRate = Baud_9600;
-	UART_Config.DataBits = Data_8;
+	UART_BAUD_ASSERT(UART_START_BAUD);
+	UART_Config.BaudRate = UART_START_BAUD;
+	UART_Config.DataBits = (UART_MPCM_BUS) ? Data_9 : Data_8;
 	UART_Config.ParityMode = Parity_Disable;
 	UART_Config.StopBits = StopBits_1;
+	UART_Config.Mode = UART_INTERRUPT_MODE;
 	UART_init(&UART_Config);
 
+	SREG |= (1<<7);												/* Enables I-bit for timer and UART */
+
+	/* Reliable link (frames with sequence numbers, ACKs and retransmission) to the Control ECU */
+	LINK_init();
+
+	/* 1 ms time base on Timer0 for the link deadlines */
+	Timebase_init();
+
+	/* Software timers ( door sequence, ALERT ) on one TIMER_TICK_MS tick of Timer1 */
+	Timer_serviceInit();
+
+#if (UART_MPCM_BUS)
+	/* Selects the door to talk to on the bus */
+	select_door();
+#endif
+
 	/*	Waits Until the other MCU is ready to communicate */
-	UART_sendByte(HMI_ECU_READY);
-	while(UART_receiveByte() != CONTROL_ECU_READY){}
+	handshake();
 
 	uint8 mainOptionKey = 0;									/* Variable that holds the mode '+' or '-' */
 
-	SREG |= (1<<7);												/* Enables I-bit for timer */
-
 	/*******************************************SUPER LOOP*******************************************/
 	for(;;)
 	{
@@ -64,13 +76,20 @@ int main (void)
 		if(g_FirstTime_flag == 0)
 		{
 			/* Keeps entering new password until it matches first and second time */
+			pass_matching = PASS_UNMATCH;
 			while(pass_matching == PASS_UNMATCH)
 			{
 				pass_Enter_1();
 				pass_Enter_2();
-				pass_matching = UART_receiveByte();
+				pass_matching = receive_pass_status();
 				pass_status(pass_matching);
 			}
+			/* Starts again from the first time setup or main options if Control ECU didn't answer */
+			if(pass_matching == LINK_ERROR)
+			{
+				link_resync();
+				continue;
+			}
 		}
 
 
@@ -80,40 +99,85 @@ int main (void)
 		mainOptionKey = main_options();
 		if(mainOptionKey == '-')								/* Open Door mode */
 		{
-			openDoorMatch(&Timer1);
+			openDoorMatch();
 		}
 		else if(mainOptionKey == '+')							/* Change Password mode */
 		{
-			changePassword(&Timer1);
+			changePassword();
 		}
+
+#if (UART_MPCM_BUS)
+		/* Next transaction may be for another door, the new session tells if it is set up */
+		select_door();
+		handshake();
+#endif
 	}
 }
 
 /*-------------------------------------------------------------------------------------------------------
- * [Description]: Function that displays the keys pressed for first entry
+ * [Description]: Function that reads password keys until enter (=) displaying (*) for each digit,
+ * then sends the whole password to Control ECU in one PASSWORD frame
  *------------------------------------------------------------------------------------------------------*/
-void pass_Enter_1(void)
+void read_and_send_password(void)
 {
-	LCD_displayStringRowColumn(0,0,"Enter New Pass:  ");
-	LCD_displayStringRowColumn(1, 0, "                ");
-	LCD_moveCursor(1, 0);
+	uint8 password[MAX_PASSWORD - 1];
+	uint8 length = 0;
 	uint8 key = 0;
-	_delay_ms(300);
+
 	while(key != '=')
 	{
 		/* Waits until keypad is pressed and save number in key variable*/
 		key = KEYPAD_getPressedKey();
-		/* Sends numbers and the enter key '=' only */
-		if( (key>=0 && key<=9) || key == '=')
-			UART_sendByte(key);
-		/* Displays (*) each time a key is pressed */
-		if(key != '=')
+		/* Keeps numbers only (as ASCII digits) and displays (*) each time a number is pressed */
+		if((key <= 9) && (length < (MAX_PASSWORD - 1)))
 		{
+			password[length] = key + '0';
+			++length;
 			LCD_displayCharacter('*');
 		}
 		/* Small delay between each key press  to avoid repetition*/
 		_delay_ms(250);
 	}
+	/* Sends the whole password when enter (=) is pressed */
+	LINK_send(PASSWORD, password, length);
+}
+
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]: Function that waits for the password result frame (PASS_MATCH / PASS_UNMATCH)
+ *------------------------------------------------------------------------------------------------------*/
+uint8 receive_pass_status(void)
+{
+	Frame_Type frame;
+	uint32 start = Timebase_getMs();
+	uint16 elapsed = 0;
+
+	/* The link drops repeated password frames so a retransmission never counts as another trial,
+	 * no answer within the deadline means the link is lost */
+	while(LINK_receiveTimeout(&frame, REPLY_TIMEOUT_MS - elapsed))
+	{
+		if((frame.type == PASS_MATCH) || (frame.type == PASS_UNMATCH))
+		{
+			return frame.type;
+		}
+		elapsed = (uint16)(Timebase_getMs() - start);
+		if(elapsed >= REPLY_TIMEOUT_MS)
+		{
+			break;
+		}
+	}
+	return LINK_ERROR;
+}
+
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]: Function that displays the keys pressed for first entry
+ *------------------------------------------------------------------------------------------------------*/
+void pass_Enter_1(void)
+{
+	LCD_displayStringRowColumn(0,0,"Enter New Pass:  ");
+	LCD_displayStringRowColumn(1, 0, "                ");
+	LCD_moveCursor(1, 0);
+	_delay_ms(300);
+	read_and_send_password();
 }
 
 /*-------------------------------------------------------------------------------------------------------
@@ -121,23 +185,10 @@ void pass_Enter_1(void)
  *------------------------------------------------------------------------------------------------------*/
 void pass_Enter_2(void)
 {
-	uint8 key = 0;
 	LCD_displayStringRowColumn(0, 0, "Re-enter Pass:  ");
 	LCD_displayStringRowColumn(1, 0, "                ");
 	LCD_moveCursor(1, 0);
-	while(key != '=')
-	{
-		/* Waits until keypad is pressed and save number in key variable*/
-		key = KEYPAD_getPressedKey();
-		/* Sends numbers and the enter key '=' only */
-		if( (key>=0 && key<=9) || key == '=')
-			UART_sendByte(key);
-		/* Displays (*) each time a key is pressed */
-		if(key != '=')
-			LCD_displayCharacter('*');
-		/* Small delay between each key press  to avoid repetition*/
-		_delay_ms(250);
-	}
+	read_and_send_password();
 }
 
 /*-------------------------------------------------------------------------------------------------------
@@ -185,43 +236,145 @@ uint8 main_options(void)
 		/* Send key to Control ECU if only available option is pressed*/
 		if(key == '+' || key == '-')
 		{
-			UART_sendByte(key);
+			LINK_send(MAIN_OPTIONS, &key, 1);
 			return key;
 		}
+#if (UART_TRACE)
+		/* Hidden option: both ECUs send their link trace for the host decoder */
+		else if(key == '%')
+		{
+			trace_dump();
+			_delay_ms(250);
+		}
+#endif
+#if (EVENT_STATS)
+		/* Hidden option: longest Timer1 ISR and the deferred work queue counters */
+		else if(key == 13)
+		{
+			event_stats();
+			LCD_clearScreen();
+			LCD_displayStringRowColumn(0, 0, "+ : Change PASS ");
+			LCD_displayStringRowColumn(1, 0, "- : Open Door   ");
+		}
+#endif
+#if (DIGEST_BENCHMARK)
+		/* Hidden option: cycles of the password digest on the Control ECU */
+		else if(key == '*')
+		{
+			digest_benchmark();
+			LCD_clearScreen();
+			LCD_displayStringRowColumn(0, 0, "+ : Change PASS ");
+			LCD_displayStringRowColumn(1, 0, "- : Open Door   ");
+		}
+#endif
 	}
 	return key;
 }
 
+#if (EVENT_STATS)
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]: Function that displays the longest Timer1 ISR ( software timers ) in microseconds, the most
+ * events that waited at once and the lost events for 3 seconds, then the cycles of the Timer0 tick ISR
+ * ( TIMER_ISR_BENCHMARK = 1 ) for 3 seconds
+ *------------------------------------------------------------------------------------------------------*/
+void event_stats(void)
+{
+	EVENT_Stats stats;
+#if (TIMER_ISR_BENCHMARK)
+	uint8 cycles;
+#endif
+
+	EVENT_getStats(&stats);
+	LCD_clearScreen();
+	LCD_displayString("Tick ISR ");
+	LCD_intgerToString(Timer_getServiceMaxUs());
+	LCD_displayString(" us");
+	LCD_displayStringRowColumn(1, 0, "Queue ");
+	LCD_intgerToString(stats.MaxPending);
+	LCD_displayString(" lost ");
+	LCD_intgerToString(stats.Lost);
+	_delay_ms(3000);
+#if (TIMER_ISR_BENCHMARK)
+	/* Whole Timer0 compare ISR in the dispatch mode of this build ( timer_cfg.h ) */
+	LCD_clearScreen();
+	LCD_displayString(TIMER_STATIC_DISPATCH ? "Static ISR" : "Pointer ISR");
+	LCD_displayStringRowColumn(1, 0, "T0 tick ");
+	cycles = Timebase_measureTickCycles();
+	if(cycles == TIMEBASE_CYCLES_OVERFLOW)
+	{
+		LCD_displayString(">254");					/* Timer2 wrapped */
+	}
+	else
+	{
+		LCD_intgerToString(cycles);
+	}
+	LCD_displayString(" cycles");
+	_delay_ms(3000);
+#endif
+}
+#endif
+
+#if (DIGEST_BENCHMARK)
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]: Function that asks Control ECU for the cycles of the password digest and of a password
+ * check ( 8 MHz ) and displays them for 3 seconds
+ *------------------------------------------------------------------------------------------------------*/
+void digest_benchmark(void)
+{
+	Frame_Type reply;
+	uint32 hash_cycles = 0;
+	uint32 verify_cycles = 0;
+	char buff[11];
+	uint8 i;
+
+	LCD_clearScreen();
+	if(!LINK_send(DIGEST_BENCH, NULL_PTR, 0) ||
+			!LINK_waitForTimeout(DIGEST_BENCH, &reply, DIGEST_BENCH_TIMEOUT_MS) || (reply.length != 8))
+	{
+		LCD_displayString("No answer");
+		_delay_ms(1000);
+		return;
+	}
+	for(i=0 ; i<4 ; ++i)
+	{
+		hash_cycles |= (uint32)reply.payload[i] << (8 * i);
+		verify_cycles |= (uint32)reply.payload[i + 4] << (8 * i);
+	}
+	LCD_displayString("Hash   ");
+	ultoa(hash_cycles, buff, 10);
+	LCD_displayString(buff);
+	LCD_displayStringRowColumn(1, 0, "Verify ");
+	ultoa(verify_cycles, buff, 10);
+	LCD_displayString(buff);
+	_delay_ms(3000);
+}
+#endif
+
+#if (UART_TRACE)
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]: Function that asks Control ECU to send its UART trace then sends the HMI one, the host
+ * records both from the link lines. Recording is paused so the dumps don't fill the traces.
+ *------------------------------------------------------------------------------------------------------*/
+void trace_dump(void)
+{
+	UART_traceEnable(FALSE);
+	FRAME_send(TRACE_DUMP, NULL_PTR, 0);
+	LINK_waitForTimeout(TRACE_END, NULL_PTR, TRACE_DUMP_TIMEOUT_MS);
+	FRAME_traceDump(TRACE_ECU_HMI);
+}
+#endif
+
 /*-------------------------------------------------------------------------------------------------------
  * [Description]: Function that displays Enter password for checking password entry
  *------------------------------------------------------------------------------------------------------*/
 void send_password(void)
 {
-	uint8 key = 0;
 	/* Displays Enter PASS on LCD and and sends password with UART to Control ECU*/
 	LCD_clearScreen();
 	LCD_displayString("Enter PASS");
 	_delay_ms(500);
 	LCD_moveCursor(1, 0);
-	/* Keeps sending password until enter is pressed or in this case '=' */
-	while(key != '=')
-	{
-		key = KEYPAD_getPressedKey();
-		/* Only sends available password keys from 0 to 9 or = to act as password end */
-		if( (key>=0 && key<=9) || key == '=')
-			UART_sendByte(key);
-		/* Displays (*) if numbers are pressed as indicator that they are pressed successfully */
-		if(key != '=')
-		{
-			LCD_displayCharacter('*');
-		}
-		/* Delay between each key press to avoid repetition */
-		_delay_ms(250);
-	}
-	if(key == '=')
-	{
-		UART_sendByte(key);
-	}
+	read_and_send_password();
 }
 
 /*-------------------------------------------------------------------------------------------------------
@@ -229,19 +382,21 @@ void send_password(void)
  * and displays Wrong password (If password doesn't match)
  * then displays ALERT (If Maximum trials exceeded)
  *------------------------------------------------------------------------------------------------------*/
-void openDoorMatch(Timer_ConfigType *Timer1)
+void openDoorMatch(void)
 {
-	/* Send to Control ECU that HMI is ready */
-	UART_sendByte(HMI_ECU_READY);
 	pass_matching = PASS_UNMATCH;
 	/* Keeps looping until password matches */
 	while(pass_matching == PASS_UNMATCH)
 	{
 		send_password();											/* Send password function send to Control ECU */
-		_delay_ms(300);
-		pass_matching = UART_receiveByte();
+		pass_matching = receive_pass_status();
 
-		if(pass_matching == PASS_UNMATCH)
+		if(pass_matching == LINK_ERROR)
+		{
+			link_resync();
+			return;
+		}
+		else if(pass_matching == PASS_UNMATCH)
 		{
 			/* If password doesn't match decrement the fail times */
 			--g_fail_count;
@@ -251,18 +406,10 @@ void openDoorMatch(Timer_ConfigType *Timer1)
 			LCD_displayStringRowColumn(1, 0, "Trials Remain: ");
 			LCD_intgerToString(g_fail_count);
 			_delay_ms(2000);
-			UART_sendByte(HMI_ECU_READY);							/* Tells MCU2 that MCU1 is ready */
 			/* Checks if Max fails reached to display ALERT */
 			if(g_fail_count == 0)
 			{
-				LCD_clearScreen();
-				LCD_displayString("Alert Thief!!");
-				Timer1->Compare_value = 58594;						/*	Activate Buzzer 1 minute	*/
-				/* Starts Timer1 to count for 60 seconds */
-				Timer_init(Timer1);
-				Timer_setCallBack(TIMER1_ID, Buzzer_fn);
-				g_fail_count = MAX_FAIL_TRIALS;						/* Resets Max fail trials counter */
-				while(UART_receiveByte() != CONTROL_ECU_READY);
+				thief_alert();
 				break;
 			}
 		}
@@ -270,46 +417,84 @@ void openDoorMatch(Timer_ConfigType *Timer1)
 		{
 			LCD_clearScreen();
 			LCD_displayString("OPENING...");
-			UART_sendByte(HMI_ECU_READY);								/* Tells MCU2 that MCU1 is ready */
-			while(UART_receiveByte() != START_TIME_15_SEC);
-			/* Starts Timer1 to count for 15 seconds door opening */
-			Timer_setCallBack(TIMER1_ID, openDoorTimer1);
-			Timer_init(Timer1);
-			while(g_Timer_Flag == 0);
-			g_Timer_Flag = 1;
+			if(!LINK_waitForTimeout(START_TIME_15_SEC, NULL_PTR, REPLY_TIMEOUT_MS))
+			{
+				link_resync();
+				return;
+			}
+			/* Starts the door timer to count for 15 seconds door opening */
+			g_Timer_Flag = 0;
+			g_OpenDoorTick = 0;
+			Timer_startSoft(&g_DoorTimer, DOOR_OPENING_MS, 0, openDoorTimer1);
+			while(g_Timer_Flag == 0)
+			{
+				EVENT_dispatch();									/* Door steps run here, not in the ISR */
+			}
+			if(g_Link_Error)
+			{
+				g_Link_Error = 0;
+				link_resync();
+			}
 		}
 	}
 }
 
 /*-------------------------------------------------------------------------------------------------------
- * [Description]:	Function to count time fort the door opening, keeping still, and closing
+ * [Description]:	Function that stops the door sequence when Control ECU doesn't answer a timer frame
+ *------------------------------------------------------------------------------------------------------*/
+static void openDoorLinkError(void)
+{
+	g_OpenDoorTick = 0;											/* Resets ISR count */
+	Timer_stopSoft(&g_DoorTimer);								/* Stops timer */
+	g_Link_Error = 1;
+	g_Timer_Flag = 1;
+}
+
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]:	Door timer call back ( Timer1 ISR ): only queues the next door step for the main loop
  *------------------------------------------------------------------------------------------------------*/
 void openDoorTimer1()
+{
+	EVENT_post(openDoorStep, 0);
+}
+
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]:	Event handler ( main loop ) that steps the door opening, keeping still, and closing
+ *------------------------------------------------------------------------------------------------------*/
+void openDoorStep(uint8 data)
 {
 	++g_OpenDoorTick;
-	if(g_OpenDoorTick == 2)											/* 15 Seconds Passed */
+	if(g_OpenDoorTick == 1)											/* 15 Seconds Passed */
 	{
-		Timer_SetCompareValue(TIMER1_ID, 23438);					/* Wait 3 Seconds Door Opened*/
-		UART_sendByte(TIME_15_SEC);
-		while(UART_receiveByte() != CONTROL_ECU_READY);
+		Timer_startSoft(&g_DoorTimer, DOOR_OPENED_MS, 0, openDoorTimer1);	/* Wait 3 Seconds Door Opened*/
+		if(!LINK_request(TIME_15_SEC, NULL_PTR, 0, CONTROL_ECU_READY, NULL_PTR))
+		{
+			openDoorLinkError();
+			return;
+		}
 		LCD_clearScreen();
 		LCD_displayString("Door Opened");
 	}
-	else if(g_OpenDoorTick == 3)
+	else if(g_OpenDoorTick == 2)
 	{
-		Timer_SetCompareValue(TIMER1_ID, 58594);					/* Wait 15 Seconds Closing Door */
-		UART_sendByte(TIME_3_SEC);
-		while(UART_receiveByte() != CONTROL_ECU_READY);
+		Timer_startSoft(&g_DoorTimer, DOOR_CLOSING_MS, 0, openDoorTimer1);	/* Wait 15 Seconds Closing Door */
+		if(!LINK_request(TIME_3_SEC, NULL_PTR, 0, CONTROL_ECU_READY, NULL_PTR))
+		{
+			openDoorLinkError();
+			return;
+		}
 		LCD_clearScreen();
 		LCD_displayString("Closing Door...");
 	}
-	else if(g_OpenDoorTick == 5)
+	else
 	{
 		/* Send that 15 Seconds are counted to Control ECU */
-		UART_sendByte(TIME_15_SEC);
-		while(UART_receiveByte() != CONTROL_ECU_READY);
+		if(!LINK_request(TIME_15_SEC, NULL_PTR, 0, CONTROL_ECU_READY, NULL_PTR))
+		{
+			openDoorLinkError();
+			return;
+		}
 		g_OpenDoorTick = 0;										/* Resets ISR count */
-		Timer_deinit(TIMER1_ID);								/* Stops timer */
 		LCD_clearScreen();
 		LCD_displayString("Door Closed");
 		g_Timer_Flag = 1;
@@ -317,18 +502,68 @@ void openDoorTimer1()
 }
 
 /*-------------------------------------------------------------------------------------------------------
- * [Description]:
- * Function that count 60 seconds then tells CONTROL ECU that it finished count
+ * [Description]:	Event handler ( main loop ) of the end of the ALERT minute, stops the seconds count and
+ * tells thief_alert it finished count
+ *------------------------------------------------------------------------------------------------------*/
+static void alertEnd(uint8 data)
+{
+	Timer_stopSoft(&g_AlertCountTimer);
+	g_Timer_Flag = 1;
+}
+
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]:	ALERT timer call back ( Timer1 ISR ): only queues the end of the ALERT for the main loop
  *------------------------------------------------------------------------------------------------------*/
 void Buzzer_fn()
 {
-	++g_BuzzerTick;
-	/* Displays the main options on LCD */
-	if(g_BuzzerTick == 8)
+	EVENT_post(alertEnd, 0);
+}
+
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]:	Event handler ( main loop ) that displays the ALERT seconds left every second
+ *------------------------------------------------------------------------------------------------------*/
+static void alertCount(uint8 data)
+{
+	if(g_AlertSeconds > 0)
 	{
-		UART_sendByte(TIME_60_SEC);
+		--g_AlertSeconds;
 	}
+	LCD_displayStringRowColumn(1, 0, "Seconds: ");
+	LCD_intgerToString(g_AlertSeconds);
+	LCD_displayString(" ");
+}
 
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]:	ALERT seconds timer call back ( Timer1 ISR ): only queues the count for the main loop
+ *------------------------------------------------------------------------------------------------------*/
+static void alertSecond(void)
+{
+	EVENT_post(alertCount, 0);
+}
+
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]:
+ * Function that displays ALERT and the seconds left for 60 seconds counted by two software timers at once
+ * then tells Control ECU to stop buzzer
+ *------------------------------------------------------------------------------------------------------*/
+void thief_alert(void)
+{
+	LCD_clearScreen();
+	LCD_displayString("Alert Thief!!");
+	g_Timer_Flag = 0;
+	g_AlertSeconds = ALERT_MS / 1000;
+	Timer_startSoft(&g_AlertCountTimer, 1000, 1000, alertSecond);	/* Seconds left on the LCD */
+	Timer_startSoft(&g_AlertTimer, ALERT_MS, 0, Buzzer_fn);			/* Counts for 60 seconds ALERT */
+	g_fail_count = MAX_FAIL_TRIALS;									/* Resets Max fail trials counter */
+	while(g_Timer_Flag == 0)
+	{
+		EVENT_dispatch();											/* Seconds count and ALERT end */
+	}
+	EVENT_dispatch();		/* A seconds count queued before alertEnd stopped its timer runs on the ALERT screen */
+	if(!LINK_request(TIME_60_SEC, NULL_PTR, 0, CONTROL_ECU_READY, NULL_PTR))
+	{
+		link_resync();
+	}
 }
 
 /*-------------------------------------------------------------------------------------------------------
@@ -336,17 +571,20 @@ void Buzzer_fn()
  * Function that sends old password to check. If password match sends new password,
  * if password doesn't match you have MAX_TRIALS to try password again then alert will be displayed
  *------------------------------------------------------------------------------------------------------*/
-void changePassword(Timer_ConfigType *Timer1)
+void changePassword(void)
 {
-	UART_sendByte(HMI_ECU_READY);
 	pass_matching = PASS_UNMATCH;
 	while(pass_matching == PASS_UNMATCH)
 	{
 		send_password();											/* Send password function send to Control ECU */
-		_delay_ms(300);
-		pass_matching = UART_receiveByte();
+		pass_matching = receive_pass_status();
 
-		if(pass_matching == PASS_UNMATCH)
+		if(pass_matching == LINK_ERROR)
+		{
+			link_resync();
+			return;
+		}
+		else if(pass_matching == PASS_UNMATCH)
 		{
 			/* If password doesn't match decrement the fail times */
 			--g_fail_count;
@@ -356,17 +594,10 @@ void changePassword(Timer_ConfigType *Timer1)
 			LCD_displayStringRowColumn(1, 0, "Trials Remain: ");
 			LCD_intgerToString(g_fail_count);
 			_delay_ms(2000);
-			UART_sendByte(HMI_ECU_READY);							/* Tells MCU2 that MCU1 is ready */
 			/* Checks if Max fails reached to display ALERT */
 			if(g_fail_count == 0)
 			{
-				LCD_clearScreen();
-				LCD_displayString("Alert Thief!!");
-				Timer1->Compare_value = 58594;						/*	Activate displaying ALERT 1 minute	*/
-				Timer_init(Timer1);									/* Starts Timer1 to count for 60 seconds ALERT*/
-				Timer_setCallBack(TIMER1_ID, Buzzer_fn);
-				g_fail_count = MAX_FAIL_TRIALS;
-				while(UART_receiveByte() != CONTROL_ECU_READY);
+				thief_alert();
 				break;
 			}
 		}
@@ -377,3 +608,84 @@ void changePassword(Timer_ConfigType *Timer1)
 		}
 	}
 }
+
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]:
+ * Function that keeps sending HMI_ECU_READY until Control ECU answers, the answer tells if a password
+ * is already saved so the first time setup is skipped and the fail trials left. Then the baud rate is stepped up to the highest
+ * rate supported by both ECUs.
+ *------------------------------------------------------------------------------------------------------*/
+void handshake(void)
+{
+	Frame_Type reply;
+	UART_BaudRate baud = UART_START_BAUD;
+
+	/* The handshake is sent as a raw frame (not through the link) and starts a new link session.
+	 * Control ECU may still be at a stepped up rate (HMI was reset), so every supported rate is tried */
+	LINK_reset();
+	UART_setBaudRate(baud);
+#if (UART_MPCM_BUS)
+	UART_sendAddress(g_DoorNode);								/* Wakes the selected door only */
+#endif
+	while(!FRAME_request(HMI_ECU_READY, NULL_PTR, 0, CONTROL_ECU_READY, &reply) || (reply.length == 0))
+	{
+		baud = UART_getNextBaud(baud);
+		UART_setBaudRate(baud);
+#if (UART_MPCM_BUS)
+		UART_sendAddress(g_DoorNode);
+#endif
+	}
+	g_FirstTime_flag = reply.payload[0];
+
+	/* Fail trials left on Control ECU ( kept across its resets ), the alarm goes off at the same trial */
+	if((reply.length >= 2) && (reply.payload[1] >= 1) && (reply.payload[1] <= MAX_FAIL_TRIALS))
+	{
+		g_fail_count = reply.payload[1];
+	}
+
+	/* Both ECUs go back to UART_START_BAUD after the handshake, then step up together */
+	UART_setBaudRate(UART_START_BAUD);
+	LINK_stepUpBaud();
+}
+
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]:
+ * Function that displays the link error and restarts the session with Control ECU after an
+ * unanswered frame, both ECUs go back to the first time setup or the main options
+ *------------------------------------------------------------------------------------------------------*/
+void link_resync(void)
+{
+	LCD_clearScreen();
+	LCD_displayString("Link Error");
+	_delay_ms(1000);
+	handshake();
+}
+
+#if (UART_MPCM_BUS)
+/*-------------------------------------------------------------------------------------------------------
+ * [Description]:
+ * Function that reads the number of the door (1 -> HMI_MAX_DOORS) to talk to on the MPCM bus, each
+ * door keeps its own fail trials counter
+ *------------------------------------------------------------------------------------------------------*/
+void select_door(void)
+{
+	uint8 key = 0;
+
+	/* Fail trials left of the previous door */
+	g_DoorFailCount[g_DoorNode - 1] = g_fail_count;
+
+	LCD_clearScreen();
+	LCD_displayString("Door Number:");
+	LCD_moveCursor(1, 0);
+	while((key < 1) || (key > HMI_MAX_DOORS))
+	{
+		key = KEYPAD_getPressedKey();
+		_delay_ms(250);
+	}
+	LCD_intgerToString(key);
+	_delay_ms(500);
+
+	g_DoorNode = key;
+	g_fail_count = g_DoorFailCount[g_DoorNode - 1];
+}
+#endif
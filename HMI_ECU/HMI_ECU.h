@@ -10,32 +10,60 @@
 #include "keypad.h"
 #include "lcd.h"
 #include "uart.h"
+#include "link.h"
+#include "timebase.h"
 #include "timer.h"
+#include "event_queue.h"
 #include "std_types.h"
 #include "util/delay.h"
 #include <avr/io.h>
+#include <stdlib.h>
 
 
-/*********************************************UART MESSAGES**********************************************/
-#define CONTROL_ECU_READY 	0x10
-#define HMI_ECU_READY		0x11
-#define PASS_MATCH			0x12
-#define PASS_UNMATCH		0x13
-#define MAIN_OPTIONS		0x14
-#define TIME_15_SEC			0x15
-#define START_TIME_15_SEC	0x16
-#define START_TIME_3_SEC	0x17
-#define TIME_3_SEC			0x18
-#define TIME_60_SEC			0x19
-#define START_TIME_60_SEC	0x20
+/* UART messages are sent through the reliable link, the frame types are shared with the Control ECU in frame.h */
 
 /***********************************************DEFINITIONS************************************************/
 
 #define MAX_FAIL_TRIALS		3
+#define MAX_PASSWORD		15				/* Including the null at the end as saved by Control ECU */
+
+/* Deadline for Control ECU answers to a message (password result, START_TIME_15_SEC): the link may
+ * need LINK_WORST_DELIVERY_MS for the message and again for the answer */
+#define REPLY_TIMEOUT_MS	(2 * LINK_WORST_DELIVERY_MS)
+/* Result of receive_pass_status when Control ECU didn't answer */
+#define LINK_ERROR			0xFF
+
+/* Doors (Control ECU node addresses 1 -> HMI_MAX_DOORS) that can be selected on the MPCM bus */
+#define HMI_MAX_DOORS		9
+
+/* Longest time Control ECU needs to send its whole trace ( UART_TRACE_SIZE entries at UART_START_BAUD ) */
+#define TRACE_DUMP_TIMEOUT_MS	1000
+
+/* Longest time Control ECU needs to measure the digest and answer */
+#define DIGEST_BENCH_TIMEOUT_MS	500
+
+/* Door sequence and ALERT times, counted by software timers ( timer.h ) */
+#define DOOR_OPENING_MS		15000
+#define DOOR_OPENED_MS		3000
+#define DOOR_CLOSING_MS		15000
+#define ALERT_MS			60000UL
+
+#if ((DOOR_OPENING_MS % TIMER_TICK_MS) != 0) || ((DOOR_OPENED_MS % TIMER_TICK_MS) != 0) || \
+	((DOOR_CLOSING_MS % TIMER_TICK_MS) != 0) || ((ALERT_MS % TIMER_TICK_MS) != 0)
+#error "The door and ALERT times must be whole software timer ticks"
+#endif
 
 
 /*****************************************FUNCTIONS DECLARATIONS******************************************/
 
+/* [Description]: Function that reads password keys until enter (=) displaying (*) for each digit,
+ * then sends the whole password to Control ECU in one PASSWORD frame */
+void read_and_send_password(void);
+
+/* [Description]: Function that waits for the password result frame (PASS_MATCH / PASS_UNMATCH),
+ * returns LINK_ERROR if Control ECU didn't answer within REPLY_TIMEOUT_MS */
+uint8 receive_pass_status(void);
+
 /* [Description]: Function that displays the keys pressed for first entry */
 void pass_Enter_1(void);
 
@@ -45,22 +73,38 @@ void pass_Enter_2(void);
 /* [Description]: Function that displays Enter password for checking password entry */
 void send_password(void);
 
-/*	[Description]:	Function to count time fort the door opening, keeping still, and closing*/
+/*	[Description]:	Door timer call back ( Timer1 ISR ) that queues the next door step for the main loop */
 void openDoorTimer1();
 
+/*	[Description]:	Event handler ( main loop ) that steps the door opening, keeping still, and closing */
+void openDoorStep(uint8 data);
+
 /* [Description]: Function that displays status of the Door if opening or closing (If password matches),
  * and displays Wrong password (If password doesn't match)
  * then displays ALERT (If Maximum trials exceeded)
  */
-void openDoorMatch(Timer_ConfigType *Timer1);
+void openDoorMatch(void);
 
-/* [Description]: Function that count 60 seconds then tells CONTROL ECU that it finished count	*/
+/* [Description]: ALERT timer call back ( Timer1 ISR ) that queues the end of the 60 seconds for the main loop	*/
 void Buzzer_fn();
 
+/* [Description]: Function that displays ALERT and the seconds left for 60 seconds counted by software
+ * timers then tells Control ECU to stop buzzer */
+void thief_alert(void);
+
+/* [Description]: Function that keeps sending HMI_ECU_READY until Control ECU answers, the answer tells
+ * if a password is already saved so the first time setup is skipped and the fail trials left on Control
+ * ECU. Then the baud rate is stepped up to the highest rate supported by both ECUs */
+void handshake(void);
+
+/* [Description]: Function that displays the link error and restarts the session with Control ECU
+ * after an unanswered frame, both ECUs go back to the first time setup or the main options */
+void link_resync(void);
+
 /* [Description]: Function that sends old password to check. If password match sends new password,
  * if password doesn't match you have MAX_TRIALS to try password again then alert will be displayed
  */
-void changePassword(Timer_ConfigType *Timer1);
+void changePassword(void);
 
 /* [Description]: Function that displays if two entries matched or no, if yes displays Saving password */
 uint8 pass_status(uint8 status);
@@ -69,5 +113,28 @@ uint8 pass_status(uint8 status);
  * a non available option is pressed */
 uint8 main_options(void);
 
+#if (EVENT_STATS)
+/* [Description]: Function that displays the longest Timer1 ISR and the deferred work queue counters */
+void event_stats(void);
+#endif
+
+#if (DIGEST_BENCHMARK)
+/* [Description]: Function that asks Control ECU for the cycles of the password digest and of a password
+ * check and displays them */
+void digest_benchmark(void);
+#endif
+
+#if (UART_TRACE)
+/* [Description]: Function that asks Control ECU to send its UART trace then sends the HMI one, the host
+ * records both from the link lines */
+void trace_dump(void);
+#endif
+
+#if (UART_MPCM_BUS)
+/* [Description]: Function that reads the number of the door (1 -> HMI_MAX_DOORS) to talk to on the
+ * MPCM bus, each door keeps its own fail trials counter */
+void select_door(void);
+#endif
+
 
 #endif /* HMI_ECU_H_ */
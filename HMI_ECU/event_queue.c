@@ -0,0 +1,99 @@
+/******************************************************************************************************
+File Name	: event_queue.c
+Author		: Sherif Beshr
+Description : Source file for the deferred work queue of the HMI ECU: ISRs post events, the main loop runs them
+*******************************************************************************************************/
+
+#include "event_queue.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+#if ((EVENT_QUEUE_SIZE & (EVENT_QUEUE_SIZE - 1)) != 0) || (EVENT_QUEUE_SIZE > 128)
+#error "EVENT_QUEUE_SIZE must be a power of 2 and not more than 128"
+#endif
+
+/***************************************************************************************************
+ *                                		Global Variables                                    	   *
+ ***************************************************************************************************/
+
+/* Ring of events: written by the ISRs (head) and read by the main loop (tail), one byte indexes are
+ * read and written in one instruction so neither side needs to disable interrupts */
+static volatile EVENT_Record g_events[EVENT_QUEUE_SIZE];
+static volatile uint8 g_eventHead = 0;
+static volatile uint8 g_eventTail = 0;
+
+/* Written by the ISRs only */
+static volatile EVENT_Stats g_eventStats;
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Queues an event for the main loop. Called from ISRs only.
+ * Returns FALSE and counts the event lost if the queue is full.
+ */
+uint8 EVENT_post(void(*handler)(uint8), uint8 data)
+{
+	uint8 head = g_eventHead;
+	uint8 next = (head + 1) & (EVENT_QUEUE_SIZE - 1);
+	uint8 pending;
+
+	if(next == g_eventTail)
+	{
+		++g_eventStats.Lost;
+		return FALSE;
+	}
+	g_events[head].Handler = handler;
+	g_events[head].Data = data;
+	g_eventHead = next;											/* Published after the record is written */
+
+	pending = (next - g_eventTail) & (EVENT_QUEUE_SIZE - 1);
+	if(pending > g_eventStats.MaxPending)
+	{
+		g_eventStats.MaxPending = pending;
+	}
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Runs the handlers of the queued events in order. Called from the main loop only.
+ * Returns the number of handlers run.
+ */
+uint8 EVENT_dispatch(void)
+{
+	EVENT_Record event;
+	uint8 tail = g_eventTail;
+	uint8 count = 0;
+
+	while(tail != g_eventHead)
+	{
+		event.Handler = g_events[tail].Handler;
+		event.Data = g_events[tail].Data;
+		tail = (tail + 1) & (EVENT_QUEUE_SIZE - 1);
+		g_eventTail = tail;										/* Slot given back before the handler runs */
+		(*event.Handler)(event.Data);
+		++count;
+	}
+	return count;
+}
+
+/*
+ * Description :
+ * Copies the queue counters.
+ */
+void EVENT_getStats(EVENT_Stats *stats)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	stats->MaxPending = g_eventStats.MaxPending;
+	stats->Lost = g_eventStats.Lost;
+	SREG = sreg;
+}
@@ -0,0 +1,66 @@
+/******************************************************************************************************
+File Name	: event_queue.h
+Author		: Sherif Beshr
+Description : Header file for the deferred work queue of the HMI ECU: ISRs post events, the main loop runs them
+*******************************************************************************************************/
+
+#ifndef EVENT_QUEUE_H_
+#define EVENT_QUEUE_H_
+
+#include "std_types.h"
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+/* Events waiting for the main loop ( Must be a power of 2 and not more than 128 ) */
+#define EVENT_QUEUE_SIZE			8
+
+/* Hidden main option ( Enter key ) of the HMI that displays the longest Timer1 ISR and the queue counters */
+#ifndef EVENT_STATS
+#define EVENT_STATS					0
+#endif
+
+/***************************************************************************************************
+ *                                		Types Decelerations                                  	   *
+ ***************************************************************************************************/
+
+/*	Event: handler run by the main loop and its data	*/
+typedef struct
+{
+	void	(*Handler)(uint8);
+	uint8	Data;
+}EVENT_Record;
+
+/*	Queue counters: most events waiting at once and events lost on a full queue	*/
+typedef struct
+{
+	uint8	MaxPending;
+	uint16	Lost;
+}EVENT_Stats;
+
+/***************************************************************************************************
+ *                                		Function Prototypes                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Queues an event for the main loop. Called from ISRs only ( they don't nest, so they are the single
+ * producer ), main code calls the handler itself. Returns FALSE and counts the event lost if the queue is full.
+ */
+uint8 EVENT_post(void(*handler)(uint8), uint8 data);
+
+/*
+ * Description :
+ * Runs the handlers of the queued events in order, with interrupts enabled. Called from the main loop
+ * only ( single consumer ). Returns the number of handlers run.
+ */
+uint8 EVENT_dispatch(void);
+
+/*
+ * Description :
+ * Copies the queue counters.
+ */
+void EVENT_getStats(EVENT_Stats *stats);
+
+#endif /* EVENT_QUEUE_H_ */
@@ -7,6 +7,23 @@ Description : Source file for the Timer AVR driver
 #include <avr/io.h>
 #include <avr/interrupt.h>
 #include "timer.h"
+#if (TIMER_STATIC_DISPATCH)
+#include "timebase.h"
+#endif
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+#define TIMER_EXPIRED_SLOT				0xFF	/* Slot of the timers expired in the tick being run */
+
+#if ((TIMER_WHEEL_SIZE & (TIMER_WHEEL_SIZE - 1)) != 0)
+#error "TIMER_WHEEL_SIZE must be a power of 2"
+#endif
+
+#if (TIMER_TICKS(1, TIMER_TICK_MS) != 1) || !TIMER_IS_VALID(1, TIMER_TICK_MS)
+#error "TIMER_TICK_MS can't be one exact compare period of Timer1 at this F_CPU"
+#endif
 
 /***************************************************************************************************
  *                                		Global Variables                                    	   *
@@ -17,6 +34,20 @@ static volatile void (*g_Timer0_callBackPtr)(void) = NULL_PTR;
 static volatile void (*g_Timer1_callBackPtr)(void) = NULL_PTR;
 static volatile void (*g_Timer2_callBackPtr)(void) = NULL_PTR;
 
+/* Software timers: list of every slot of the wheel, the expired ones are moved to g_expired in a tick */
+static Timer_SoftTimer *g_wheel[TIMER_WHEEL_SIZE];
+static Timer_SoftTimer *g_expired = NULL_PTR;
+static uint8 g_wheelPosition = 0;
+
+/* Longest tick ISR in Timer1 counts: from the compare match ( the count restarts at 0 ) to the end of the tick */
+static volatile uint16 g_tickMaxCounts = 0;
+
+/***************************************************************************************************
+ *                                		Function Prototypes                                  	   *
+ ***************************************************************************************************/
+
+static void Timer_serviceTick(void);
+
 
 /***************************************************************************************************
  *                                	Interrupt Service Routine                                      *
@@ -35,11 +66,15 @@ ISR(TIMER0_OVF_vect)
 /*	Timer0 callback function for compare mode*/
 ISR(TIMER0_COMP_vect)
 {
+#if (TIMER_STATIC_DISPATCH)
+	TIMER0_COMP_HANDLER();
+#else
 	if (g_Timer0_callBackPtr != NULL_PTR)
 	{
 		/* Call the Call Back function in the application after the edge is detected */
 		(*g_Timer0_callBackPtr)(); /* call the function using pointer to function g_Timer0_callBackPtr(); */
 	}
+#endif
 }
 
 /*	Timer1 callback function for overflow mode*/
@@ -55,11 +90,15 @@ ISR(TIMER1_OVF_vect)
 /*	Timer1 callback function for compare (A) mode*/
 ISR(TIMER1_COMPA_vect)
 {
+#if (TIMER_STATIC_DISPATCH)
+	TIMER1_COMPA_HANDLER();
+#else
 	if (g_Timer1_callBackPtr != NULL_PTR)
 	{
 		/* Call the Call Back function in the application after the edge is detected */
 		(*g_Timer1_callBackPtr)(); /* call the function using pointer to function g_Timer1_callBackPtr(); */
 	}
+#endif
 }
 
 /*	Timer1 callback function for compare (B) mode*/
@@ -235,7 +274,7 @@ void Timer_deinit(Timer_ID timer_ID)
 	if(timer_ID == TIMER0_ID)				/* De-initialize Timer0 */
 	{
 		TCCR0 = 0;
-		TCNT1 = 0;
+		TCNT0 = 0;
 		TIMSK &= ~(1<<TOIE0);
 		TIMSK &= ~(1<<OCIE0);
 	}
@@ -300,3 +339,203 @@ void Timer_SetCompareValue(Timer_ID timer_ID, uint16 compare_value)
 		OCR2 = compare_value;
 	}
 }
+
+/*
+ * Description :
+ * Returns the head of the list a software timer is linked in.
+ */
+static Timer_SoftTimer **Timer_listHead(uint8 slot)
+{
+	return (slot == TIMER_EXPIRED_SLOT) ? &g_expired : &g_wheel[slot];
+}
+
+/*
+ * Description :
+ * Links a software timer at the head of the list of a slot.
+ */
+static void Timer_link(Timer_SoftTimer *timer, uint8 slot)
+{
+	Timer_SoftTimer **head = Timer_listHead(slot);
+
+	timer->Slot = slot;
+	timer->prev = NULL_PTR;
+	timer->next = *head;
+	if(*head != NULL_PTR)
+	{
+		(*head)->prev = timer;
+	}
+	*head = timer;
+}
+
+/*
+ * Description :
+ * Unlinks a software timer from the list of its slot.
+ */
+static void Timer_unlink(Timer_SoftTimer *timer)
+{
+	if(timer->prev != NULL_PTR)
+	{
+		timer->prev->next = timer->next;
+	}
+	else
+	{
+		*Timer_listHead(timer->Slot) = timer->next;
+	}
+	if(timer->next != NULL_PTR)
+	{
+		timer->next->prev = timer->prev;
+	}
+}
+
+/*
+ * Description :
+ * Puts a software timer in the wheel to expire in ticks ( at least 1 ): in the slot the wheel reaches
+ * after ticks, with the number of whole turns to wait there.
+ */
+static void Timer_insert(Timer_SoftTimer *timer, uint32 ticks)
+{
+	if(ticks == 0)
+	{
+		ticks = 1;
+	}
+	timer->Rounds = (uint16)((ticks - 1) / TIMER_WHEEL_SIZE);
+	timer->Active = TRUE;
+	Timer_link(timer, (uint8)((g_wheelPosition + ticks) & (TIMER_WHEEL_SIZE - 1)));
+}
+
+/*
+ * Description :
+ * Timer1 call back, every TIMER_TICK_MS: moves the wheel to the next slot, the timers of the slot with no
+ * turn left are moved to the expired list then their call backs are called one by one ( a call back can
+ * start or stop any timer, an expired one included ).
+ */
+static void Timer_serviceTick(void)
+{
+	Timer_SoftTimer *timer;
+	Timer_SoftTimer *next;
+
+	g_wheelPosition = (g_wheelPosition + 1) & (TIMER_WHEEL_SIZE - 1);
+	for(timer = g_wheel[g_wheelPosition] ; timer != NULL_PTR ; timer = next)
+	{
+		next = timer->next;
+		if(timer->Rounds > 0)
+		{
+			--timer->Rounds;
+		}
+		else
+		{
+			Timer_unlink(timer);
+			Timer_link(timer, TIMER_EXPIRED_SLOT);
+		}
+	}
+
+	while(g_expired != NULL_PTR)
+	{
+		timer = g_expired;
+		Timer_unlink(timer);
+		timer->Active = FALSE;
+		if(timer->PeriodTicks != 0)
+		{
+			Timer_insert(timer, timer->PeriodTicks);
+		}
+		(*timer->CallBack)();
+	}
+
+	if(TCNT1 > g_tickMaxCounts)
+	{
+		g_tickMaxCounts = TCNT1;
+	}
+}
+
+/*
+ * Description :
+ * Starts the software timers service: Timer1 interrupts every TIMER_TICK_MS and turns the wheel.
+ */
+void Timer_serviceInit(void)
+{
+	Timer_ConfigType Timer1;
+	uint8 slot;
+
+	for(slot=0 ; slot<TIMER_WHEEL_SIZE ; ++slot)
+	{
+		g_wheel[slot] = NULL_PTR;
+	}
+	g_expired = NULL_PTR;
+	g_wheelPosition = 0;
+	g_tickMaxCounts = 0;
+
+	Timer1.Start_value = 0;
+	Timer1.Compare_value = TIMER_COMPARE(1, TIMER_TICK_MS);
+	Timer1.Timerx_ID = TIMER1_ID;
+	Timer1.Timer_mode = TIMER_COMPARE_MODE;
+	Timer1.Timer_Source = TIMER_SOURCE(1, TIMER_TICK_MS);
+	Timer1.Timer_Compare_Match = TIMERx_COMPARE_NORMAL_NO_OCx;
+#if (!TIMER_STATIC_DISPATCH)
+	Timer_setCallBack(TIMER1_ID, Timer_serviceTick);
+#endif
+	Timer_init(&Timer1);
+}
+
+/*
+ * Description :
+ * Starts ( or restarts ) a software timer: the call back is called from the Timer1 ISR after delay_ms
+ * ( rounded up to TIMER_TICK_MS ), then every period_ms if it isn't 0.
+ */
+void Timer_startSoft(Timer_SoftTimer *timer, uint32 delay_ms, uint32 period_ms, void(*a_ptr)(void))
+{
+	uint8 sreg = SREG;
+
+	cli();
+	if(timer->Active)
+	{
+		Timer_unlink(timer);
+	}
+	timer->CallBack = a_ptr;
+	timer->PeriodTicks = (uint16)TIMER_MS_TO_TICKS(period_ms);
+	Timer_insert(timer, TIMER_MS_TO_TICKS(delay_ms));
+	SREG = sreg;
+}
+
+/*
+ * Description :
+ * Stops a software timer, its call back isn't called anymore.
+ */
+void Timer_stopSoft(Timer_SoftTimer *timer)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	if(timer->Active)
+	{
+		Timer_unlink(timer);
+		timer->Active = FALSE;
+	}
+	timer->PeriodTicks = 0;
+	SREG = sreg;
+}
+
+/*
+ * Description :
+ * Returns TRUE while a software timer runs.
+ */
+uint8 Timer_isSoftActive(const Timer_SoftTimer *timer)
+{
+	return timer->Active;
+}
+
+/*
+ * Description :
+ * Returns the longest time in microseconds from a Timer1 tick to the end of its ISR ( the wheel and the call
+ * backs, interrupt latency included ).
+ */
+uint16 Timer_getServiceMaxUs(void)
+{
+	uint16 counts;
+	uint8 sreg = SREG;
+
+	cli();
+	counts = g_tickMaxCounts;
+	SREG = sreg;
+
+	return (uint16)(((uint32)counts * TIMER_DIVIDER(1, TIMER_TICK_MS) * 1000UL) / ((F_CPU) / 1000UL));
+}
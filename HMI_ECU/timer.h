@@ -8,6 +8,57 @@ Description : Header file for the Timer AVR driver
 #define TIMER_H_
 
 #include "std_types.h"
+#include "timer_cfg.h"
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+/*
+ * Compare mode configuration of a period of ms milliseconds ( more than 0 ) on Timer 0, 1 or 2 ( timer is the
+ * number ): the smallest pre-scalar ( best resolution ) whose counts fit in one compare period, else pre-scalar
+ * 1024 and the period counted in TIMER_TICKS interrupts of TIMER_COMPARE + 1 counts each.
+ * The real period is TIMER_TICKS x (TIMER_COMPARE + 1) x TIMER_DIVIDER cycles of F_CPU, TIMER_ERROR_PERMILLE
+ * away from ms. All the macros are evaluated by the compiler, so they can be used in #if checks with plain
+ * numbers ( TIMER_SOURCE is the Timer_Source value of TIMER_DIVIDER, for the configuration only ).
+ */
+#ifndef F_CPU
+#error "F_CPU must be defined to compute the timer configurations"
+#endif
+
+#define TIMER_TOLERANCE_PERMILLE		1
+#define TIMER_TOP(timer)				(((timer) == 1) ? 65536UL : 256UL)
+#define TIMER_CYCLES(ms)				(((F_CPU) / 1000UL) * (ms))
+#define TIMER_COUNTS(ms, div)			((TIMER_CYCLES(ms) + (div) / 2) / (div))
+#define TIMER_FITS(timer, ms, div)		(TIMER_COUNTS(ms, div) <= TIMER_TOP(timer))
+#define TIMER_DIVIDER(timer, ms)		(TIMER_FITS(timer, ms, 1UL) ? 1UL : \
+										TIMER_FITS(timer, ms, 8UL) ? 8UL : \
+										(((timer) == 2) && TIMER_FITS(timer, ms, 32UL)) ? 32UL : \
+										TIMER_FITS(timer, ms, 64UL) ? 64UL : \
+										(((timer) == 2) && TIMER_FITS(timer, ms, 128UL)) ? 128UL : \
+										TIMER_FITS(timer, ms, 256UL) ? 256UL : 1024UL)
+#define TIMER_TICKS(timer, ms)			((TIMER_COUNTS(ms, TIMER_DIVIDER(timer, ms)) + TIMER_TOP(timer) - 1) / \
+										TIMER_TOP(timer))
+#define TIMER_COMPARE(timer, ms)		(((TIMER_COUNTS(ms, TIMER_DIVIDER(timer, ms)) + TIMER_TICKS(timer, ms) / 2) / \
+										TIMER_TICKS(timer, ms)) - 1)
+#define TIMER_REAL_CYCLES(timer, ms)	(TIMER_TICKS(timer, ms) * (TIMER_COMPARE(timer, ms) + 1) * TIMER_DIVIDER(timer, ms))
+#define TIMER_ERROR_PERMILLE(timer, ms)	((TIMER_REAL_CYCLES(timer, ms) > TIMER_CYCLES(ms)) ? \
+										(((TIMER_REAL_CYCLES(timer, ms) - TIMER_CYCLES(ms)) * 1000UL) / TIMER_CYCLES(ms)) : \
+										(((TIMER_CYCLES(ms) - TIMER_REAL_CYCLES(timer, ms)) * 1000UL) / TIMER_CYCLES(ms)))
+#define TIMER_IS_VALID(timer, ms)		(TIMER_ERROR_PERMILLE(timer, ms) <= TIMER_TOLERANCE_PERMILLE)
+
+/* Pre-scalar codes: 1, 8, 64, 256, 1024 for Timer 0 and 1 and 1, 8, 32, 64, 128, 256, 1024 for Timer 2 */
+#define TIMER_SOURCE_CODE(timer, div)	(((div) == 1UL) ? 1 : ((div) == 8UL) ? 2 : \
+										((timer) != 2) ? (((div) == 64UL) ? 3 : ((div) == 256UL) ? 4 : 5) : \
+										((div) == 32UL) ? 3 : ((div) == 64UL) ? 4 : ((div) == 128UL) ? 5 : \
+										((div) == 256UL) ? 6 : 7)
+#define TIMER_SOURCE(timer, ms)			((Timer_Source)TIMER_SOURCE_CODE(timer, TIMER_DIVIDER(timer, ms)))
+
+/* Software timers: hashed wheel of TIMER_WHEEL_SIZE slots turned by one Timer1 compare interrupt every
+ * TIMER_TICK_MS ( 8MHz: pre-scalar 8, 10000 counts ) */
+#define TIMER_TICK_MS					10
+#define TIMER_WHEEL_SIZE				16		/* Slots ( Must be a power of 2 ) */
+#define TIMER_MS_TO_TICKS(ms)			(((ms) + TIMER_TICK_MS - 1) / TIMER_TICK_MS)
 
 /***************************************************************************************************
  *                                		Types Decelerations                                  	   *
@@ -61,6 +112,25 @@ typedef struct{
 	Timer_Compare_Match	Timer_Compare_Match;
 }Timer_ConfigType;
 
+/*	Software timer, owned by the caller ( static ) and linked in the wheel while it runs:
+ * 	1- Links of the list of its slot
+ * 	2- Wheel turns left before it expires
+ * 	3- Slot of the wheel
+ * 	4- TRUE while it runs
+ * 	5- Period in ticks, 0 for a one-shot timer
+ * 	6- Call back function called from the Timer1 ISR when it expires
+ */
+typedef struct Timer_SoftTimer
+{
+	struct Timer_SoftTimer	*next;
+	struct Timer_SoftTimer	*prev;
+	uint16					Rounds;
+	uint8					Slot;
+	uint8					Active;
+	uint16					PeriodTicks;
+	void					(*CallBack)(void);
+}Timer_SoftTimer;
+
 /***************************************************************************************************
  *                                		Function Prototypes                                 	   *
  ***************************************************************************************************/
@@ -98,5 +168,39 @@ void Timer_SetStartValue(Timer_ID timer_ID, uint16 start_value);
  */
 void Timer_SetCompareValue(Timer_ID timer_ID, uint16 compare_value);
 
+/*
+ * Description :
+ * Starts the software timers service: Timer1 interrupts every TIMER_TICK_MS and turns the wheel.
+ * Timer1 can't be used by anything else then.
+ */
+void Timer_serviceInit(void);
+
+/*
+ * Description :
+ * Starts ( or restarts ) a software timer: the call back is called from the Timer1 ISR after delay_ms
+ * ( rounded up to TIMER_TICK_MS, up to 10485 seconds ), then every period_ms if it isn't 0 ( up to 655
+ * seconds ). O(1), can be called from a call back.
+ */
+void Timer_startSoft(Timer_SoftTimer *timer, uint32 delay_ms, uint32 period_ms, void(*a_ptr)(void));
+
+/*
+ * Description :
+ * Stops a software timer, its call back isn't called anymore. O(1), can be called from a call back.
+ */
+void Timer_stopSoft(Timer_SoftTimer *timer);
+
+/*
+ * Description :
+ * Returns TRUE while a software timer runs ( a one-shot timer stops before its call back ).
+ */
+uint8 Timer_isSoftActive(const Timer_SoftTimer *timer);
+
+/*
+ * Description :
+ * Returns the longest time in microseconds from a Timer1 tick to the end of its ISR ( the wheel and the call
+ * backs, interrupt latency included ), measured on the Timer1 count since Timer_serviceInit.
+ */
+uint16 Timer_getServiceMaxUs(void);
+
 
 #endif /* TIMER_H_ */
@@ -0,0 +1,38 @@
+/******************************************************************************************************
+File Name	: timer_cfg.h
+Author		: Sherif Beshr
+Description : Build time configuration of the Timer AVR driver: dispatch of the timer interrupts
+*******************************************************************************************************/
+
+#ifndef TIMER_CFG_H_
+#define TIMER_CFG_H_
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+/*
+ * Dispatch of the timer interrupts, can be changed with -DTIMER_STATIC_DISPATCH=<0/1>:
+ * 0: every ISR calls the call back given to Timer_setCallBack through a pointer, so the ISR saves all the
+ *    call-clobbered registers for the unknown function.
+ * 1: the vectors bound below call their handler directly and the compiler inlines it into the ISR, which then
+ *    saves only the registers the handler uses. Timer_setCallBack isn't used for them, the other vectors
+ *    keep the call back pointers.
+ */
+#ifndef TIMER_STATIC_DISPATCH
+#define TIMER_STATIC_DISPATCH			0
+#endif
+
+/* Handlers bound at build time ( static inline or static in timer.c so they can be inlined ) */
+#define TIMER0_COMP_HANDLER()			Timebase_tick()			/* 1 ms time base ( timebase.h ) */
+#define TIMER1_COMPA_HANDLER()			Timer_serviceTick()		/* Software timers ( timer.c ) */
+
+/*
+ * Timebase_measureTickCycles: CPU cycles of the Timer0 compare ISR from the interrupt to the end of its reti,
+ * to compare both dispatch modes ( Timer2 is used as the cycle counter while it runs ).
+ */
+#ifndef TIMER_ISR_BENCHMARK
+#define TIMER_ISR_BENCHMARK				0
+#endif
+
+#endif /* TIMER_CFG_H_ */
@@ -9,6 +9,89 @@ Description : Header file for the UART AVR driver
 
 #include "std_types.h"
 
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+/* Ring buffer sizes used in interrupt mode ( Must be a power of 2 and not more than 128 ) */
+#define UART_RX_BUFFER_SIZE			32
+#define UART_TX_BUFFER_SIZE			32
+
+/*
+ * Baud rate generator (U2X = 1): UBRR = F_CPU / (8 x BAUD) - 1, rounded to the nearest value.
+ * The real rate is F_CPU / (8 x (UBRR + 1)), its error must stay within UART_BAUD_TOLERANCE_PERMILLE
+ * (datasheet recommended receiver error for 8 data bits with U2X is +/-1.5%).
+ * All the macros are evaluated by the compiler, so they can be used in #if checks with plain numbers.
+ */
+#ifndef F_CPU
+#error "F_CPU must be defined to compute the baud rate"
+#endif
+
+#define UART_BAUD_TOLERANCE_PERMILLE	15
+#define UART_UBRR(baud)					((((F_CPU) + 4UL * (baud)) / (8UL * (baud))) - 1)
+#define UART_REAL_BAUD(baud)			((F_CPU) / (8UL * (UART_UBRR(baud) + 1)))
+#define UART_BAUD_ERROR_PERMILLE(baud)	((UART_REAL_BAUD(baud) > (baud)) ? \
+										(((UART_REAL_BAUD(baud) - (baud)) * 1000UL) / (baud)) : \
+										((((baud) - UART_REAL_BAUD(baud)) * 1000UL) / (baud)))
+#define UART_BAUD_IS_VALID(baud)		((UART_UBRR(baud) <= 4095) && \
+										(UART_BAUD_ERROR_PERMILLE(baud) <= UART_BAUD_TOLERANCE_PERMILLE))
+
+/*
+ * Link baud rates: both ECUs start at UART_START_BAUD and step up after the ready handshake to the
+ * highest rate supported by both. UART_MAX_BAUD limits the rates this ECU accepts (RX interrupt load),
+ * it can be lowered per ECU with -DUART_MAX_BAUD=<rate>.
+ */
+#define UART_START_BAUD					9600
+#ifndef UART_MAX_BAUD
+#define UART_MAX_BAUD					250000
+#endif
+
+#if !UART_BAUD_IS_VALID(UART_START_BAUD)
+#error "UART_START_BAUD can't be reached within UART_BAUD_TOLERANCE_PERMILLE at this F_CPU"
+#endif
+#if !UART_BAUD_IS_VALID(UART_MAX_BAUD)
+#error "UART_MAX_BAUD can't be reached within UART_BAUD_TOLERANCE_PERMILLE at this F_CPU"
+#endif
+#if (UART_MAX_BAUD < UART_START_BAUD)
+#error "UART_MAX_BAUD must not be less than UART_START_BAUD"
+#endif
+
+/* Build time check of the rate given to UART_init where it is configured ( enum values can't be tested
+ * with #if ): the array size is negative so the build fails if the rate is out of tolerance at this F_CPU
+ * or above UART_MAX_BAUD. UART_init has no fallback rate. */
+#define UART_BAUD_ASSERT(baud)			typedef char UART_BaudAssert[(UART_BAUD_IS_VALID(baud) && \
+										((baud) <= UART_MAX_BAUD)) ? 1 : -1] __attribute__((unused))
+
+/*
+ * Multi-processor communication (MPCM) bus: one HMI (master) and many Control ECUs (nodes) share the
+ * line with 9 data bits. The master sends an address frame (9th bit = 1) and only the addressed node
+ * leaves MPCM to receive the data frames (9th bit = 0) that follow, the other nodes skip them in
+ * hardware (RXC isn't even raised). A node only enables its transmitter while it is addressed, TXD is
+ * released otherwise. Node TX pins must still be joined with diodes and a pull-up (wired-AND) or open
+ * drain buffers, a push-pull TXD of a node that starts up or misses an address frame would short the line.
+ * 0 = point to point link, 1 = MPCM bus ( set for all the ECUs with -DUART_MPCM_BUS=1 ).
+ */
+#ifndef UART_MPCM_BUS
+#define UART_MPCM_BUS					0
+#endif
+#define UART_NO_ADDRESS					0xFF	/* Node address of a point to point UART */
+
+/*
+ * Link trace (debug builds, -DUART_TRACE=1): every sent and received byte is recorded with a 16-bit
+ * millisecond timestamp (Timebase_getMs) in a circular SRAM buffer of UART_TRACE_SIZE entries, the
+ * oldest entries are overwritten when it is full. FRAME_traceDump sends it in TRACE_* frames.
+ */
+#ifndef UART_TRACE
+#define UART_TRACE						0
+#endif
+#ifndef UART_TRACE_SIZE
+#define UART_TRACE_SIZE					32		/* Entries of 4 bytes ( Must be a power of 2 ), 128 bytes of SRAM */
+#endif
+
+/* Trace entry flags */
+#define UART_TRACE_TX					0x01	/* Byte sent (received if cleared) */
+#define UART_TRACE_ADDRESS				0x02	/* MPCM address frame (9th bit set) */
+
 /***************************************************************************************************
  *                                		Types Decelerations                                  	   *
  ***************************************************************************************************/
@@ -21,10 +104,10 @@ typedef enum
 	Baud_230400=230400, Baud_250k=250000,	Baud_500k=500000,	Baud_1M=1000000
 }UART_BaudRate;
 
-/*	Number of bits to send	*/
+/*	Number of bits to send ( 9 bits are needed by the MPCM bus, the 9th bit marks address frames )	*/
 typedef enum
 {
-	Data_5, Data_6, Data_7, Data_8
+	Data_5, Data_6, Data_7, Data_8, Data_9=7
 }UART_DataBits;
 
 /*	Parity checking mode that check for number of '1' in frame */
@@ -39,11 +122,30 @@ typedef enum
 	StopBits_1, StopBits_2
 }UART_StopBits;
 
+/*	Driver mode: busy-wait on the flags or let the RXC/UDRE interrupts fill and drain ring buffers	*/
+typedef enum
+{
+	UART_POLLING_MODE, UART_INTERRUPT_MODE
+}UART_Mode;
+
+/*	One trace entry as recorded and dumped:
+ *  1- Low 16 bits of Timebase_getMs when the byte was written to / read from UDR
+ *  2- UART_TRACE_TX / UART_TRACE_ADDRESS flags
+ *  3- Byte
+ */
+typedef struct
+{
+	uint16	time;
+	uint8	flags;
+	uint8	data;
+}UART_TraceEntry;
+
 /*	Structure accessed to choose the UART different modes selecting
  *  1- Baud Rate that is the speed of transfer
  *  2- Data bits sent each time
  *  3- Parity mode to be disabled/enabled for checking data is sent correctly
  *  4- Stop bits at the end of each frame ( 1-bit or 2-bits )
+ *  5- Driver mode ( Polling or Interrupt driven with RX/TX ring buffers )
  */
 typedef struct
 {
@@ -51,6 +153,7 @@ typedef struct
 	UART_DataBits 	DataBits;
 	UART_ParityMode ParityMode;
 	UART_StopBits	StopBits;
+	UART_Mode		Mode;
 }UART_ConfigType;
 
 /***************************************************************************************************
@@ -62,22 +165,137 @@ typedef struct
  * Functional responsible for Initializing the UART device by:
  * 1. Setup the Frame format like number of data bits, parity bit type and number of stop bits.
  * 2. Enable the UART.
- * 3. Setup the UART baud rate.
+ * 3. Setup the UART baud rate, check it with UART_BAUD_ASSERT where it is configured ( the UART stays
+ *    disabled if the rate is not supported ).
  */
 void UART_init(const UART_ConfigType* Config_Ptr);
 
+/*
+ * Description :
+ * Changes the baud rate after all queued bytes are sent. UBRR comes from a table computed at build time.
+ * Returns FALSE (rate not changed) if the rate is out of tolerance or above UART_MAX_BAUD.
+ */
+uint8 UART_setBaudRate(UART_BaudRate baud);
+
+/*
+ * Description :
+ * Returns the baud rates this ECU supports as a mask, bit n is the n-th rate of UART_BaudRate.
+ */
+uint16 UART_getSupportedBauds(void);
+
+/*
+ * Description :
+ * Returns the highest baud rate in a mask of UART_getSupportedBauds, UART_START_BAUD if it is empty.
+ */
+UART_BaudRate UART_getHighestBaud(uint16 mask);
+
+/*
+ * Description :
+ * Returns the next higher supported baud rate, after the highest one it wraps to the lowest one.
+ */
+UART_BaudRate UART_getNextBaud(UART_BaudRate baud);
+
+/*
+ * Description :
+ * Blocks until all the queued bytes and the byte in the shift register are sent.
+ */
+void UART_flushTx(void);
+
+/*
+ * Description :
+ * Makes this UART a node of the MPCM bus (Interrupt mode with Data_9 only): received bytes are ignored
+ * until an address frame with this address arrives, and again after an address frame of another node
+ * (the baud rate goes back to UART_START_BAUD then). Nothing is sent while it isn't addressed. Pass
+ * UART_NO_ADDRESS to leave the bus mode.
+ */
+void UART_setNodeAddress(uint8 address);
+
+/*
+ * Description :
+ * Returns TRUE if this UART may send: point to point link, or node of the MPCM bus addressed by the
+ * master. Bytes sent while it isn't addressed are dropped.
+ */
+uint8 UART_isAddressed(void);
+
+/*
+ * Description :
+ * Sends an address frame (9th bit = 1) on the MPCM bus (Data_9 only) after the queued data bytes.
+ * The addressed node receives the next data bytes and the previous one goes back to ignoring them.
+ */
+void UART_sendAddress(uint8 address);
+
+#if (UART_TRACE)
+/*
+ * Description :
+ * Starts (TRUE) or pauses (FALSE) recording the link bytes, paused while the trace itself is sent.
+ */
+void UART_traceEnable(uint8 enable);
+
+/*
+ * Description :
+ * Takes the oldest trace entry out of the buffer. Returns FALSE if the buffer is empty.
+ */
+uint8 UART_traceRead(UART_TraceEntry *entry);
+
+/*
+ * Description :
+ * Returns the number of entries overwritten since the last call (buffer was full) and clears it.
+ */
+uint16 UART_traceLost(void);
+#endif
+
 /*
  * Description :
  * Functional responsible for send byte to another UART device.
+ * Blocks until the byte is accepted by the UDR register or the TX ring buffer.
  */
 void UART_sendByte(const uint8 data);
 
 /*
  * Description :
  * Functional responsible for receive byte from another UART device.
+ * Blocks until a byte is available in the UDR register or the RX ring buffer.
  */
 uint8 UART_receiveByte(void);
 
+/*
+ * Description :
+ * Functional responsible for receive byte from another UART device within timeout_ms milliseconds.
+ * Returns TRUE and stores the byte in data if it arrived in time, FALSE if the timeout expired.
+ * Needs the time base (Timebase_init) to be running.
+ */
+uint8 UART_receiveByteTimeout(uint16 timeout_ms, uint8 *data);
+
+/*
+ * Description :
+ * Non-blocking send. Queues the byte in the TX ring buffer (Interrupt mode) or writes it to UDR
+ * if the transmitter is free (Polling mode).
+ * Returns TRUE if the byte is accepted, FALSE if there is no room for it now.
+ */
+uint8 UART_queueSend(const uint8 data);
+
+/*
+ * Description :
+ * Non-blocking receive. Takes the oldest byte from the RX ring buffer (Interrupt mode) or from UDR
+ * if a byte has arrived (Polling mode).
+ * Returns TRUE and stores the byte in data if one is available, FALSE otherwise.
+ */
+uint8 UART_tryReceive(uint8 *data);
+
+/*
+ * Description :
+ * Services a received byte by polling when the RXC interrupt can't run because the global interrupts
+ * are disabled (called from inside another ISR). Does nothing in any other case.
+ */
+void UART_rxPoll(void);
+
+/*
+ * Description: Function to set the receive Call Back function address (Interrupt mode only).
+ * Each received byte is passed to the call back from the RXC ISR instead of the RX ring buffer.
+ * Pass NULL_PTR to go back to the RX ring buffer.
+ */
+void UART_setRxCallBack(void(*a_ptr)(uint8));
+
 /*
  * Description :
  * Send the required string through UART to the other UART device.
@@ -0,0 +1,26 @@
+/******************************************************************************************************
+File Name	: eeprom.h
+Author		: Sherif Beshr
+Description : Host (Linux) build of the internal EEPROM functions of avr-libc used by the ECUs. The
+			  EEMEM variables are in RAM, in the section eemem so a benchmark can erase them all
+			  ( __start_eemem / __stop_eemem ) as a new ATmega16 would be.
+*******************************************************************************************************/
+
+#ifndef HOST_AVR_EEPROM_H_
+#define HOST_AVR_EEPROM_H_
+
+#include <string.h>
+
+#define EEMEM		__attribute__((section("eemem"), used))
+
+static inline void eeprom_read_block(void *dst, const void *src, size_t n)
+{
+	memcpy(dst, src, n);
+}
+
+static inline void eeprom_update_block(const void *src, void *dst, size_t n)
+{
+	memcpy(dst, src, n);
+}
+
+#endif /* HOST_AVR_EEPROM_H_ */
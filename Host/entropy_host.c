@@ -0,0 +1,43 @@
+/******************************************************************************************************
+File Name	: entropy_host.c
+Author		: Sherif Beshr
+Description : Host (Linux) build of the seed of the salts on /dev/urandom, the seed isn't saved
+*******************************************************************************************************/
+
+#include <stdio.h>
+#include "entropy.h"
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Fills ENTROPY_SIZE bytes from /dev/urandom ( zeros if it can't be read ).
+ */
+void ENTROPY_get(uint8 *seed)
+{
+	FILE *file = fopen("/dev/urandom", "rb");
+	uint8 i;
+
+	if((file == NULL) || (fread(seed, 1, ENTROPY_SIZE, file) != ENTROPY_SIZE))
+	{
+		for(i=0 ; i<ENTROPY_SIZE ; ++i)
+		{
+			seed[i] = 0;
+		}
+	}
+	if(file != NULL)
+	{
+		fclose(file);
+	}
+}
+
+/*
+ * Description :
+ * Nothing to save on the host, every ENTROPY_get reads new bytes.
+ */
+void ENTROPY_save(const uint8 *seed)
+{
+	(void)seed;
+}
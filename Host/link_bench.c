@@ -0,0 +1,165 @@
+/******************************************************************************************************
+File Name	: link_bench.c
+Author		: Sherif Beshr
+Description : Host (Linux) benchmark of the HMI <-> Control protocol. frame.c and link.c of the ECUs
+			  run unchanged on uart_pty.c, one process per ECU connected through pty_bridge:
+			  - control : answers the handshake, the baud rate step up and every PASSWORD with PASS_MATCH
+			  - hmi     : handshake, optional baud step up, then n password transactions, printing the
+			              transaction times and the link counters
+Usage		: UART_PTY=<pty> link_bench control
+			  UART_PTY=<pty> link_bench hmi [transactions] [step_up (0/1)]
+*******************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "std_types.h"
+#include "uart.h"
+#include "timebase.h"
+#include "frame.h"
+#include "link.h"
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+#define BENCH_REPLY_TIMEOUT_MS		(2 * LINK_WORST_DELIVERY_MS)
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Control ECU side: same answers as receive_frame of CONTROL_ECU.c, a password always matches.
+ */
+static void benchControl(void)
+{
+	Frame_Type frame;
+	uint8 setup_state = TRUE;
+
+	for(;;)
+	{
+		if(!LINK_receive(&frame))
+		{
+			continue;								/* Link error, waits for the HMI handshake */
+		}
+		switch(frame.type)
+		{
+		case HMI_ECU_READY:
+			LINK_reset();
+			FRAME_send(CONTROL_ECU_READY, &setup_state, 1);
+			UART_setBaudRate(UART_START_BAUD);
+			break;
+		case BAUD_REQUEST:
+			LINK_acceptBaud(&frame);
+			break;
+		case BAUD_CONFIRM:
+			FRAME_send(BAUD_CONFIRM, NULL_PTR, 0);
+			break;
+		case PASSWORD:
+			LINK_send(PASS_MATCH, NULL_PTR, 0);
+			break;
+		}
+	}
+}
+
+/*
+ * Description :
+ * HMI ECU side: handshake (every supported rate is tried), optional step up, then the transactions.
+ */
+static void benchHmi(uint16 transactions, uint8 step_up)
+{
+	static const uint8 password[] = "12345";
+	Frame_Type reply;
+	LINK_Stats stats;
+	UART_BaudRate baud = UART_START_BAUD;
+	uint32 start;
+	uint32 elapsed;
+	uint32 total = 0;
+	uint32 min = 0xFFFFFFFFUL;
+	uint32 max = 0;
+	uint16 ok = 0;
+	uint16 failed = 0;
+	uint16 i;
+
+	start = Timebase_getMs();
+	LINK_reset();
+	while(!FRAME_request(HMI_ECU_READY, NULL_PTR, 0, CONTROL_ECU_READY, &reply) || (reply.length == 0))
+	{
+		baud = UART_getNextBaud(baud);
+		UART_setBaudRate(baud);
+	}
+	UART_setBaudRate(UART_START_BAUD);
+	baud = UART_START_BAUD;
+	if(step_up && LINK_stepUpBaud())
+	{
+		baud = UART_getHighestBaud(0xFFFF);
+	}
+	printf("handshake    : %lu ms, link at %lu baud\n", (unsigned long)(Timebase_getMs() - start), (unsigned long)baud);
+
+	for(i=0 ; i<transactions ; ++i)
+	{
+		start = Timebase_getUs();
+		if(LINK_send(PASSWORD, password, sizeof(password) - 1) &&
+				LINK_waitForTimeout(PASS_MATCH, NULL_PTR, BENCH_REPLY_TIMEOUT_MS))
+		{
+			elapsed = Timebase_getUs() - start;
+			total += elapsed;
+			min = (elapsed < min) ? elapsed : min;
+			max = (elapsed > max) ? elapsed : max;
+			++ok;
+		}
+		else
+		{
+			/* Recovery as link_resync of the HMI: new session at the start rate */
+			++failed;
+			LINK_reset();
+			UART_setBaudRate(UART_START_BAUD);
+			while(!FRAME_request(HMI_ECU_READY, NULL_PTR, 0, CONTROL_ECU_READY, &reply) || (reply.length == 0)){}
+			UART_setBaudRate(UART_START_BAUD);
+			if(step_up)
+			{
+				LINK_stepUpBaud();
+			}
+		}
+	}
+
+	LINK_getStats(&stats);
+	printf("transactions : %u ok, %u failed (resync)\n", ok, failed);
+	if(ok > 0)
+	{
+		printf("time         : min %.3f ms, avg %.3f ms, max %.3f ms\n",
+				min / 1000.0, (double)total / ok / 1000.0, max / 1000.0);
+	}
+	printf("link         : %u sent, %u retransmits, %u received, %u duplicates, %u link errors\n",
+			stats.txFrames, stats.retransmits, stats.rxFrames, stats.duplicates, stats.linkErrors);
+	printf("rtt          : last %u ms, smoothed %u ms, max %u ms\n",
+			stats.rttLastMs, stats.rttSmoothMs, stats.rttMaxMs);
+	printf("handshake    : max recovery %u ms\n", FRAME_getMaxRecoveryMs());
+}
+
+int main(int argc, char **argv)
+{
+	UART_ConfigType UART_Config = { UART_START_BAUD, Data_8, Parity_Disable, StopBits_1, UART_INTERRUPT_MODE };
+
+	if((argc < 2) || ((strcmp(argv[1], "hmi") != 0) && (strcmp(argv[1], "control") != 0)))
+	{
+		fprintf(stderr, "usage: UART_PTY=<pty> %s control | hmi [transactions] [step_up (0/1)]\n", argv[0]);
+		return 1;
+	}
+
+	UART_init(&UART_Config);
+	Timebase_init();
+	LINK_init();
+
+	if(strcmp(argv[1], "control") == 0)
+	{
+		benchControl();
+	}
+	else
+	{
+		benchHmi((argc > 2) ? (uint16)atoi(argv[2]) : 100, (argc > 3) ? (uint8)atoi(argv[3]) : 1);
+	}
+	return 0;
+}
@@ -0,0 +1,310 @@
+/******************************************************************************************************
+File Name	: pty_bridge.c
+Author		: Sherif Beshr
+Description : Host (Linux) emulation of the UART line between the HMI and Control ECUs. Creates two
+			  pseudo terminals (one per ECU, see uart_pty.c) and forwards the bytes between them:
+			  - paced at the baud rate each side set on its PTY (10 bits per byte), bytes sent at a
+			    rate the receiver isn't set to arrive corrupted as on a real line
+			  - delayed by a fixed latency
+			  - with random bit errors and dropped bytes
+Usage		: pty_bridge [-l latency_us] [-b bit_error_rate] [-d drop_rate] [-s seed] [-n hmi_link -c control_link]
+*******************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <asm/termbits.h>
+#include "std_types.h"
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+#define BRIDGE_QUEUE_SIZE		4096		/* Bytes on the line per direction ( Must be a power of 2 ) */
+#define BRIDGE_BITS_PER_BYTE	10			/* Start + 8 data + stop */
+
+/***************************************************************************************************
+ *                                		Types Decelerations                                  	   *
+ ***************************************************************************************************/
+
+/*	Byte on the line and the time it reaches the receiver	*/
+typedef struct
+{
+	long long	deliverUs;
+	uint8		data;
+}Bridge_Byte;
+
+/*	One direction of the line	*/
+typedef struct
+{
+	int			from;						/* PTY master of the sender */
+	int			to;							/* PTY master of the receiver */
+	const char	*name;
+	Bridge_Byte	queue[BRIDGE_QUEUE_SIZE];
+	uint16		head;
+	uint16		tail;
+	long long	lineFreeUs;					/* End of the byte being sent */
+	uint32		bytes;
+	uint32		dropped;
+	uint32		corrupted;
+}Bridge_Direction;
+
+/***************************************************************************************************
+ *                                		Global Variables                                    	   *
+ ***************************************************************************************************/
+
+static long g_latencyUs = 0;
+static double g_bitErrorRate = 0.0;
+static double g_dropRate = 0.0;
+static volatile sig_atomic_t g_stop = 0;
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Returns the monotonic time in microseconds.
+ */
+static long long nowUs(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (long long)now.tv_sec * 1000000LL + now.tv_nsec / 1000;
+}
+
+/*
+ * Description :
+ * Returns the baud rate the ECU set on its side of the PTY.
+ */
+static unsigned int ptyBaud(int master)
+{
+	struct termios2 tio;
+
+	if(ioctl(master, TCGETS2, &tio) < 0)
+	{
+		return 9600;
+	}
+	return tio.c_ospeed;
+}
+
+/*
+ * Description :
+ * Opens a PTY master in raw mode and prints the slave name (optionally linked to a fixed path).
+ */
+static int openPty(const char *role, const char *link)
+{
+	struct termios2 tio;
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+
+	if((master < 0) || (grantpt(master) < 0) || (unlockpt(master) < 0))
+	{
+		perror("posix_openpt");
+		exit(1);
+	}
+	ioctl(master, TCGETS2, &tio);
+	tio.c_iflag = 0;
+	tio.c_oflag = 0;
+	tio.c_lflag = 0;
+	tio.c_cflag = (tio.c_cflag & ~CSIZE) | CS8 | CREAD | CLOCAL;
+	ioctl(master, TCSETS2, &tio);
+
+	if(link != NULL)
+	{
+		unlink(link);
+		if(symlink(ptsname(master), link) < 0)
+		{
+			perror(link);
+			exit(1);
+		}
+	}
+	printf("%-8s UART_PTY=%s\n", role, (link != NULL) ? link : ptsname(master));
+	return master;
+}
+
+/*
+ * Description :
+ * Reads the bytes sent on one direction and puts them on the line with their delivery time.
+ */
+static void lineSend(Bridge_Direction *dir)
+{
+	uint8 buffer[256];
+	unsigned int txBaud = ptyBaud(dir->from);
+	unsigned int rxBaud = ptyBaud(dir->to);
+	long long byteUs = (BRIDGE_BITS_PER_BYTE * 1000000LL) / txBaud;
+	long long now = nowUs();
+	ssize_t count = read(dir->from, buffer, sizeof(buffer));
+	ssize_t i;
+	uint8 bit;
+	uint8 data;
+
+	for(i=0 ; i<count ; ++i)
+	{
+		/* Pacing: a byte starts when the previous one is out */
+		if(dir->lineFreeUs < now)
+		{
+			dir->lineFreeUs = now;
+		}
+		dir->lineFreeUs += byteUs;
+		++dir->bytes;
+
+		if(((double)rand() / RAND_MAX) < g_dropRate)
+		{
+			++dir->dropped;
+			continue;
+		}
+
+		data = buffer[i];
+		if(txBaud != rxBaud)
+		{
+			data = (uint8)rand();					/* Receiver samples at another rate */
+		}
+		for(bit=0 ; bit<8 ; ++bit)
+		{
+			if(((double)rand() / RAND_MAX) < g_bitErrorRate)
+			{
+				data ^= (1 << bit);
+			}
+		}
+		if(data != buffer[i])
+		{
+			++dir->corrupted;
+		}
+
+		if(((dir->head + 1) & (BRIDGE_QUEUE_SIZE - 1)) == dir->tail)
+		{
+			++dir->dropped;							/* Line queue overflow */
+			continue;
+		}
+		dir->queue[dir->head].deliverUs = dir->lineFreeUs + g_latencyUs;
+		dir->queue[dir->head].data = data;
+		dir->head = (dir->head + 1) & (BRIDGE_QUEUE_SIZE - 1);
+	}
+}
+
+/*
+ * Description :
+ * Delivers the bytes whose time came. Returns the microseconds until the next one (-1 if none).
+ */
+static long long lineDeliver(Bridge_Direction *dir)
+{
+	long long now = nowUs();
+
+	while((dir->tail != dir->head) && (dir->queue[dir->tail].deliverUs <= now))
+	{
+		if(write(dir->to, &dir->queue[dir->tail].data, 1) != 1)
+		{
+			break;
+		}
+		dir->tail = (dir->tail + 1) & (BRIDGE_QUEUE_SIZE - 1);
+	}
+	return (dir->tail == dir->head) ? -1 : (dir->queue[dir->tail].deliverUs - now);
+}
+
+/*
+ * Description :
+ * SIGINT / SIGTERM: stops the bridge, the counters are printed on the way out.
+ */
+static void onSignal(int signal)
+{
+	(void)signal;
+	g_stop = 1;
+}
+
+/*
+ * Description :
+ * Prints the counters of one direction.
+ */
+static void printStats(const Bridge_Direction *dir)
+{
+	fprintf(stderr, "%s : %lu bytes, %lu dropped, %lu corrupted\n", dir->name,
+			(unsigned long)dir->bytes, (unsigned long)dir->dropped, (unsigned long)dir->corrupted);
+}
+
+int main(int argc, char **argv)
+{
+	static Bridge_Direction toControl = { .name = "HMI -> Control" };
+	static Bridge_Direction toHmi = { .name = "Control -> HMI" };
+	const char *hmiLink = NULL;
+	const char *controlLink = NULL;
+	struct pollfd pfd[2];
+	long long wait1;
+	long long wait2;
+	int timeout_ms;
+	int hmi;
+	int control;
+	int opt;
+
+	srand((unsigned int)time(NULL));
+	while((opt = getopt(argc, argv, "l:b:d:s:n:c:")) != -1)
+	{
+		switch(opt)
+		{
+		case 'l': g_latencyUs = atol(optarg);				break;
+		case 'b': g_bitErrorRate = atof(optarg);			break;
+		case 'd': g_dropRate = atof(optarg);				break;
+		case 's': srand((unsigned int)atoi(optarg));		break;
+		case 'n': hmiLink = optarg;							break;
+		case 'c': controlLink = optarg;						break;
+		default:
+			fprintf(stderr, "usage: %s [-l latency_us] [-b bit_error_rate] [-d drop_rate] [-s seed] "
+					"[-n hmi_link -c control_link]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	hmi = openPty("HMI", hmiLink);
+	control = openPty("Control", controlLink);
+	fflush(stdout);
+
+	toControl.from = hmi;
+	toControl.to = control;
+	toHmi.from = control;
+	toHmi.to = hmi;
+	signal(SIGINT, onSignal);
+	signal(SIGTERM, onSignal);
+
+	while(!g_stop)
+	{
+		wait1 = lineDeliver(&toControl);
+		wait2 = lineDeliver(&toHmi);
+		if((wait1 < 0) || ((wait2 >= 0) && (wait2 < wait1)))
+		{
+			wait1 = wait2;
+		}
+		timeout_ms = (wait1 < 0) ? 1000 : (int)((wait1 + 999) / 1000);
+
+		/* POLLHUP until the ECU opens its side, wait without polling that PTY then */
+		pfd[0].fd = hmi;
+		pfd[0].events = POLLIN;
+		pfd[1].fd = control;
+		pfd[1].events = POLLIN;
+		if(poll(pfd, 2, timeout_ms) < 0)
+		{
+			continue;							/* Interrupted by a signal */
+		}
+		if(pfd[0].revents & POLLIN)
+		{
+			lineSend(&toControl);
+		}
+		if(pfd[1].revents & POLLIN)
+		{
+			lineSend(&toHmi);
+		}
+		if((pfd[0].revents | pfd[1].revents) & POLLHUP)
+		{
+			usleep(1000);
+		}
+	}
+	printStats(&toControl);
+	printStats(&toHmi);
+	return 0;
+}
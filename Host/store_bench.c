@@ -0,0 +1,179 @@
+/******************************************************************************************************
+File Name	: store_bench.c
+Author		: Sherif Beshr
+Description : Host (Linux) benchmark of the credential storage strategies on the emulated 24C16
+			  ( twi_host.c ), external_eeprom.c and credential_store.c unchanged. The same record
+			  ( STORE_Record, 22 bytes ) is updated n times:
+			  - bytes in place : one EEPROM_writeByte per byte at the same address ( first firmware )
+			  - page in place  : one EEPROM_writePage at the same address
+			  - log ring       : STORE_append, a new slot of the ring every time
+			  and the bus time, the write cycles and the wear of the most written cell are printed, with
+			  the updates until that cell reaches the endurance of the 24C16. The boot read is measured
+			  too ( the log ring is scanned with the internal EEPROM erased ).
+Usage		: store_bench [updates] [eeprom image file]
+*******************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "std_types.h"
+#include "timebase.h"
+#include "twi_host.h"
+#include "external_eeprom.h"
+#include "credential_store.h"
+
+/***************************************************************************************************
+ *                                		Types Decelerations                                  	   *
+ ***************************************************************************************************/
+
+/*	Storage strategy: one update of the record, and the read of the newest one at boot	*/
+typedef struct
+{
+	const char	*name;
+	void		(*update)(uint16 sequence);
+	uint8		(*boot)(void);
+}Bench_Strategy;
+
+/***************************************************************************************************
+ *                                		Global Variables                                    	   *
+ ***************************************************************************************************/
+
+static STORE_Record g_record;
+
+/* Internal EEPROM of the host build ( avr/eeprom.h ) */
+extern uint8 __start_eemem[];
+extern uint8 __stop_eemem[];
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Fills the record of an update: the data stays the same, the sequence number changes.
+ */
+static void fillRecord(uint16 sequence)
+{
+	uint8 i;
+
+	g_record.Magic = STORE_MAGIC;
+	g_record.Version = STORE_VERSION;
+	g_record.Sequence = sequence;
+	g_record.Length = STORE_DATA_SIZE;
+	for(i=0 ; i<STORE_DATA_SIZE ; ++i)
+	{
+		g_record.Data[i] = (uint8)(0x30 + i);
+	}
+	g_record.Crc = 0;
+}
+
+static void updateBytes(uint16 sequence)
+{
+	uint8 i;
+
+	fillRecord(sequence);
+	for(i=0 ; i<sizeof(STORE_Record) ; ++i)
+	{
+		EEPROM_writeByte(STORE_LOG_ADDRESS + i, ((const uint8 *)&g_record)[i]);
+	}
+}
+
+static void updatePage(uint16 sequence)
+{
+	fillRecord(sequence);
+	EEPROM_writePage(STORE_LOG_ADDRESS, (const uint8 *)&g_record, sizeof(STORE_Record));
+}
+
+static void updateLog(uint16 sequence)
+{
+	fillRecord(sequence);
+	STORE_append(g_record.Data, STORE_DATA_SIZE, NULL_PTR);
+	while(EEPROM_isPending());
+}
+
+static uint8 bootInPlace(void)
+{
+	return (EEPROM_readBlock(STORE_LOG_ADDRESS, (uint8 *)&g_record, sizeof(STORE_Record)) == SUCCESS);
+}
+
+static uint8 bootLog(void)
+{
+	uint8 data[STORE_DATA_SIZE];
+	uint8 length;
+
+	memset(__start_eemem, 0xFF, __stop_eemem - __start_eemem);		/* Cold tier scan */
+	return STORE_init(data, &length);
+}
+
+/*
+ * Description :
+ * Runs n updates of a strategy on an erased EEPROM and prints its costs.
+ */
+static void benchStrategy(const Bench_Strategy *strategy, uint32 n)
+{
+	TWI_EmuStats stats;
+	uint8 data[STORE_DATA_SIZE];
+	uint8 length;
+	uint32 maxWear = 0;
+	uint32 wear;
+	uint32 i;
+
+	memset(TWI_emuMemory(), 0xFF, EMU_SIZE);
+	memset(__start_eemem, 0xFF, __stop_eemem - __start_eemem);
+	STORE_init(data, &length);											/* Ring position of the log */
+	TWI_emuResetStats();
+
+	for(i=0 ; i<n ; ++i)
+	{
+		(*strategy->update)((uint16)i);
+	}
+	TWI_emuGetStats(&stats);
+	for(i=0 ; i<EMU_SIZE ; ++i)
+	{
+		wear = TWI_emuWear((uint16)i);
+		maxWear = (wear > maxWear) ? wear : maxWear;
+	}
+	printf("%-15s | bus %7.3f ms | %5.1f transactions | %6.1f polls | %4.1f write cycles | max wear %6lu"
+			" | lifetime %10lu updates",
+			strategy->name, (double)stats.BusTimeNs / 1e6 / n, (double)stats.Transactions / n,
+			(double)stats.Nacks / n, (double)stats.WriteCycles / n, (unsigned long)maxWear,
+			(unsigned long)((double)EMU_ENDURANCE * n / maxWear));
+
+	TWI_emuResetStats();
+	if(!(*strategy->boot)())
+	{
+		printf(" | boot FAILED\n");
+		return;
+	}
+	TWI_emuGetStats(&stats);
+	printf(" | boot %6.3f ms\n", (double)stats.BusTimeNs / 1e6);
+}
+
+int main(int argc, char **argv)
+{
+	static const Bench_Strategy strategies[] =
+	{
+		{ "bytes in place", updateBytes, bootInPlace },
+		{ "page in place", updatePage, bootInPlace },
+		{ "log ring", updateLog, bootLog },
+	};
+	TWI_ConfigType TWI_Config = { 400000, 0x02, TWI_PRESCALAR_1 };
+	uint32 n = (argc > 1) ? (uint32)atol(argv[1]) : 1000;
+	uint8 i;
+
+	if((n == 0) || !TWI_emuOpen((argc > 2) ? argv[2] : NULL_PTR))
+	{
+		fprintf(stderr, "usage: %s [updates] [eeprom image file]\n", argv[0]);
+		return 1;
+	}
+	Timebase_init();
+	TWI_init(&TWI_Config);
+
+	printf("%lu updates of a %u bytes record, 24C16 at 400 kHz, tWR %u us\n",
+			(unsigned long)n, (unsigned int)sizeof(STORE_Record), EMU_WRITE_CYCLE_US);
+	for(i=0 ; i<(sizeof(strategies) / sizeof(strategies[0])) ; ++i)
+	{
+		benchStrategy(&strategies[i], n);
+	}
+	return 0;
+}
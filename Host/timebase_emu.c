@@ -0,0 +1,47 @@
+/******************************************************************************************************
+File Name	: timebase_emu.c
+Author		: Sherif Beshr
+Description : Host (Linux) build of the time base ( timebase.h API ) on the time of the emulated 24C16
+			  ( twi_host.c ), so the deadlines and the acknowledge poll spacing of external_eeprom.c
+			  follow the bus and not the PC. Every read of the time is a pass of the polling loop of the
+			  firmware: it lets EMU_LOOP_NS of idle bus go by.
+*******************************************************************************************************/
+
+#include "timebase.h"
+#include "twi_host.h"
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+#define EMU_LOOP_NS		10000		/* Pass of a polling loop of the firmware ( 80 cycles at 8 MHz ) */
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Nothing to start: the time of the emulator starts at TWI_emuOpen.
+ */
+void Timebase_init(void)
+{
+}
+
+/*
+ * Description :
+ * Returns the number of milliseconds since TWI_emuOpen.
+ */
+uint32 Timebase_getMs(void)
+{
+	return (uint32)(TWI_emuIdle(EMU_LOOP_NS) / 1000000);
+}
+
+/*
+ * Description :
+ * Returns the number of microseconds since TWI_emuOpen.
+ */
+uint32 Timebase_getUs(void)
+{
+	return (uint32)(TWI_emuIdle(EMU_LOOP_NS) / 1000);
+}
@@ -0,0 +1,51 @@
+/******************************************************************************************************
+File Name	: timebase_host.c
+Author		: Sherif Beshr
+Description : Host (Linux) build of the millisecond / microsecond time base on the monotonic clock
+*******************************************************************************************************/
+
+#include <time.h>
+#include "timebase.h"
+
+/***************************************************************************************************
+ *                                		Global Variables                                    	   *
+ ***************************************************************************************************/
+
+static struct timespec g_start;
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Starts counting the milliseconds.
+ */
+void Timebase_init(void)
+{
+	clock_gettime(CLOCK_MONOTONIC, &g_start);
+}
+
+/*
+ * Description :
+ * Returns the number of milliseconds since Timebase_init.
+ */
+uint32 Timebase_getMs(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32)((now.tv_sec - g_start.tv_sec) * 1000L + (now.tv_nsec - g_start.tv_nsec) / 1000000L);
+}
+
+/*
+ * Description :
+ * Returns the number of microseconds since Timebase_init.
+ */
+uint32 Timebase_getUs(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32)((now.tv_sec - g_start.tv_sec) * 1000000L + (now.tv_nsec - g_start.tv_nsec) / 1000L);
+}
@@ -0,0 +1,473 @@
+/******************************************************************************************************
+File Name	: trace_decode.c
+Author		: Sherif Beshr
+Description : Host decoder of the UART link traces dumped by the HMI and Control ECUs (UART_TRACE = 1).
+			  Reads raw captures of the link lines, rebuilds the frames each ECU sent and received
+			  with their timestamps and prints the latency of every password transaction:
+			  keypress (PASSWORD sent) -> verdict (PASS_MATCH / PASS_UNMATCH) -> motor start.
+Usage		: trace_decode <capture> [capture ...]
+*******************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "std_types.h"
+#include "frame.h"
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+#define MAX_TRACE_BYTES			4096		/* Trace entries kept per ECU ( all dumps together ) */
+#define MAX_TRACE_FRAMES		1024		/* Frames rebuilt per ECU and direction */
+#define NO_TIME					(-1L)
+
+/***************************************************************************************************
+ *                                		Types Decelerations                                  	   *
+ ***************************************************************************************************/
+
+/*	Trace entry with its timestamp unwrapped to the ECU milliseconds	*/
+typedef struct
+{
+	long	time;
+	uint8	flags;
+	uint8	data;
+}Trace_Byte;
+
+/*	Frame rebuilt from the traced bytes: first/last byte times, message type (inner type of LINK_DATA)	*/
+typedef struct
+{
+	long		start;
+	long		end;
+	Frame_Type	frame;
+	uint8		type;
+}Trace_Frame;
+
+/*	All the traces of one ECU	*/
+typedef struct
+{
+	uint8		id;
+	Trace_Byte	bytes[MAX_TRACE_BYTES];
+	uint16		count;
+	uint32		lost;
+	Trace_Frame	tx[MAX_TRACE_FRAMES];
+	uint16		txCount;
+	Trace_Frame	rx[MAX_TRACE_FRAMES];
+	uint16		rxCount;
+}Trace_Ecu;
+
+/*	Frame parser state (same as the receive state machine of frame.c)	*/
+typedef struct
+{
+	uint8		state;
+	uint8		index;
+	uint8		crc;
+	long		start;
+	Frame_Type	frame;
+}Frame_Parser;
+
+/***************************************************************************************************
+ *                                		Global Variables                                    	   *
+ ***************************************************************************************************/
+
+static Trace_Ecu g_hmi = { .id = TRACE_ECU_HMI };
+static Trace_Ecu g_control = { .id = TRACE_ECU_CONTROL };
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Adds one byte to a running CRC-8 (polynomial 0x07), same as frame.c.
+ */
+static uint8 crc8Update(uint8 crc, uint8 data)
+{
+	uint8 bit;
+
+	crc ^= data;
+	for(bit=0 ; bit<8 ; ++bit)
+	{
+		crc = (crc & 0x80) ? (uint8)((crc << 1) ^ FRAME_CRC8_POLY) : (uint8)(crc << 1);
+	}
+	return crc;
+}
+
+/*
+ * Description :
+ * Feeds one byte to a frame parser. Returns TRUE when a whole frame with a correct CRC is ready.
+ */
+static uint8 parserFeed(Frame_Parser *parser, uint8 data, long time)
+{
+	switch(parser->state)
+	{
+	case 0:
+		if(data == FRAME_START_BYTE)
+		{
+			parser->crc = 0;
+			parser->start = time;
+			parser->state = 1;
+		}
+		break;
+	case 1:
+		parser->frame.type = data;
+		parser->crc = crc8Update(parser->crc, data);
+		parser->state = 2;
+		break;
+	case 2:
+		if(data > FRAME_MAX_PAYLOAD)
+		{
+			parser->state = 0;
+			break;
+		}
+		parser->frame.length = data;
+		parser->index = 0;
+		parser->crc = crc8Update(parser->crc, data);
+		parser->state = (data == 0) ? 4 : 3;
+		break;
+	case 3:
+		parser->frame.payload[parser->index++] = data;
+		parser->crc = crc8Update(parser->crc, data);
+		if(parser->index == parser->frame.length)
+		{
+			parser->state = 4;
+		}
+		break;
+	default:
+		parser->state = 0;
+		return (data == parser->crc);
+	}
+	return FALSE;
+}
+
+/*
+ * Description :
+ * Returns the ECU traces of a TRACE_START ECU ID, NULL if unknown.
+ */
+static Trace_Ecu *findEcu(uint8 id)
+{
+	if(id == TRACE_ECU_HMI)
+	{
+		return &g_hmi;
+	}
+	if(id == TRACE_ECU_CONTROL)
+	{
+		return &g_control;
+	}
+	return NULL;
+}
+
+/*
+ * Description :
+ * Unwraps the 16-bit timestamps of one dump backwards from the dump time (now) and appends them to the
+ * ECU trace.
+ */
+static void addDump(Trace_Ecu *ecu, const Trace_Byte *dump, uint16 count, unsigned long now)
+{
+	long time = (long)now;
+	uint16 next = (uint16)now;
+	uint16 i;
+
+	if(((uint32)ecu->count + count) > MAX_TRACE_BYTES)
+	{
+		fprintf(stderr, "trace of ECU '%c' too long, dump dropped\n", ecu->id);
+		return;
+	}
+	for(i=count ; i>0 ; --i)
+	{
+		time -= (uint16)(next - (uint16)dump[i - 1].time);
+		next = (uint16)dump[i - 1].time;
+		ecu->bytes[ecu->count + i - 1] = dump[i - 1];
+		ecu->bytes[ecu->count + i - 1].time = time;
+	}
+	ecu->count += count;
+}
+
+/*
+ * Description :
+ * Reads a capture of a link line and extracts the trace dumps (TRACE_START, TRACE_DATA..., TRACE_END).
+ */
+static void readCapture(const char *name)
+{
+	static Trace_Byte dump[MAX_TRACE_BYTES];
+	Frame_Parser parser = { 0 };
+	Trace_Ecu *ecu = NULL;
+	unsigned long now = 0;
+	uint16 count = 0;
+	uint8 i;
+	int c;
+	FILE *file = fopen(name, "rb");
+
+	if(file == NULL)
+	{
+		perror(name);
+		exit(1);
+	}
+
+	while((c = fgetc(file)) != EOF)
+	{
+		if(!parserFeed(&parser, (uint8)c, 0))
+		{
+			continue;
+		}
+
+		switch(parser.frame.type)
+		{
+		case TRACE_START:
+			ecu = (parser.frame.length == 7) ? findEcu(parser.frame.payload[0]) : NULL;
+			if(ecu != NULL)
+			{
+				ecu->lost += parser.frame.payload[1] | (parser.frame.payload[2] << 8);
+				now = (unsigned long)parser.frame.payload[3] | ((unsigned long)parser.frame.payload[4] << 8) |
+						((unsigned long)parser.frame.payload[5] << 16) | ((unsigned long)parser.frame.payload[6] << 24);
+			}
+			count = 0;
+			break;
+
+		case TRACE_DATA:
+			for(i=0 ; (ecu != NULL) && ((i + TRACE_ENTRY_SIZE) <= parser.frame.length) ; i+=TRACE_ENTRY_SIZE)
+			{
+				if(count < MAX_TRACE_BYTES)
+				{
+					dump[count].time = parser.frame.payload[i] | (parser.frame.payload[i + 1] << 8);
+					dump[count].flags = parser.frame.payload[i + 2];
+					dump[count].data = parser.frame.payload[i + 3];
+					++count;
+				}
+			}
+			break;
+
+		case TRACE_END:
+			if(ecu != NULL)
+			{
+				addDump(ecu, dump, count, now);
+			}
+			ecu = NULL;
+			break;
+		}
+	}
+	fclose(file);
+}
+
+/*
+ * Description :
+ * Rebuilds the frames sent and received by an ECU from its traced bytes.
+ */
+static void buildFrames(Trace_Ecu *ecu)
+{
+	Frame_Parser txParser = { 0 };
+	Frame_Parser rxParser = { 0 };
+	Frame_Parser *parser;
+	Trace_Frame *frame;
+	uint16 i;
+
+	for(i=0 ; i<ecu->count ; ++i)
+	{
+		if(ecu->bytes[i].flags & UART_TRACE_ADDRESS)
+		{
+			continue;									/* MPCM address frames are not part of frames */
+		}
+		parser = (ecu->bytes[i].flags & UART_TRACE_TX) ? &txParser : &rxParser;
+		if(!parserFeed(parser, ecu->bytes[i].data, ecu->bytes[i].time))
+		{
+			continue;
+		}
+		if(parser->frame.type == LINK_ACK)
+		{
+			continue;
+		}
+
+		if(parser == &txParser)
+		{
+			if(ecu->txCount == MAX_TRACE_FRAMES) continue;
+			frame = &ecu->tx[ecu->txCount++];
+		}
+		else
+		{
+			if(ecu->rxCount == MAX_TRACE_FRAMES) continue;
+			frame = &ecu->rx[ecu->rxCount++];
+		}
+		frame->start = parser->start;
+		frame->end = ecu->bytes[i].time;
+		frame->frame = parser->frame;
+		frame->type = parser->frame.type;
+		if((parser->frame.type == LINK_DATA) && (parser->frame.length >= 2))
+		{
+			frame->type = parser->frame.payload[1];
+		}
+	}
+}
+
+/*
+ * Description :
+ * Returns the minimum delay (receiver time - sender time) of the frames sent by one ECU and received by
+ * the other one, matched in order by their bytes. NO_TIME if no frame matched.
+ */
+static long minDelay(Trace_Frame *tx, uint16 txCount, Trace_Frame *rx, uint16 rxCount)
+{
+	long best = NO_TIME;
+	long delay;
+	uint16 r = 0;
+	uint16 t;
+
+	for(t=0 ; t<txCount ; ++t)
+	{
+		uint16 search;
+		for(search=r ; search<rxCount ; ++search)
+		{
+			if((rx[search].frame.type == tx[t].frame.type) && (rx[search].frame.length == tx[t].frame.length) &&
+					(memcmp(rx[search].frame.payload, tx[t].frame.payload, tx[t].frame.length) == 0))
+			{
+				delay = rx[search].end - tx[t].end;
+				if((best == NO_TIME) || (delay < best))
+				{
+					best = delay;
+				}
+				r = search + 1;
+				break;
+			}
+		}
+	}
+	return best;
+}
+
+/*
+ * Description :
+ * Returns the first frame of a type in a list at or after a time, NULL if none.
+ */
+static Trace_Frame *findAfter(Trace_Frame *frames, uint16 count, uint8 type1, uint8 type2, long time)
+{
+	uint16 i;
+
+	for(i=0 ; i<count ; ++i)
+	{
+		if(((frames[i].type == type1) || (frames[i].type == type2)) && (frames[i].start >= time))
+		{
+			return &frames[i];
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Description :
+ * Prints the latency of every password transaction on the HMI time line. offset is Control time - HMI
+ * time, NO_TIME if only the HMI trace is known.
+ */
+static void printTransactions(long offset)
+{
+	Trace_Frame *password;
+	Trace_Frame *verdict;
+	Trace_Frame *controlRx;
+	Trace_Frame *controlVerdict;
+	Trace_Frame *motor;
+	uint16 i;
+	uint16 n = 0;
+
+	printf("\n txn |  verdict     | HMI->Ctrl | Ctrl check | Ctrl->HMI | keypress->verdict | verdict->motor\n");
+	for(i=0 ; i<g_hmi.txCount ; ++i)
+	{
+		password = &g_hmi.tx[i];
+		if(password->type != PASSWORD)
+		{
+			continue;
+		}
+		verdict = findAfter(g_hmi.rx, g_hmi.rxCount, PASS_MATCH, PASS_UNMATCH, password->start);
+		printf(" %3u | %-12s |", ++n, (verdict == NULL) ? "(none)" :
+				((verdict->type == PASS_MATCH) ? "PASS_MATCH" : "PASS_UNMATCH"));
+
+		controlRx = NULL;
+		controlVerdict = NULL;
+		motor = NULL;
+		if(offset != NO_TIME)
+		{
+			controlRx = findAfter(g_control.rx, g_control.rxCount, PASSWORD, PASSWORD, password->start + offset);
+		}
+		if(controlRx != NULL)
+		{
+			controlVerdict = findAfter(g_control.tx, g_control.txCount, PASS_MATCH, PASS_UNMATCH, controlRx->end);
+		}
+		if((controlVerdict != NULL) && (controlVerdict->type == PASS_MATCH))
+		{
+			motor = findAfter(g_control.tx, g_control.txCount, START_TIME_15_SEC, START_TIME_15_SEC, controlVerdict->end);
+		}
+
+		if(controlRx != NULL)
+			printf(" %6ld ms |", controlRx->end - offset - password->end);
+		else
+			printf("         - |");
+		if((controlRx != NULL) && (controlVerdict != NULL))
+			printf("  %6ld ms |", controlVerdict->start - controlRx->end);
+		else
+			printf("          - |");
+		if((controlVerdict != NULL) && (verdict != NULL))
+			printf(" %6ld ms |", verdict->end - (controlVerdict->end - offset));
+		else
+			printf("         - |");
+		if(verdict != NULL)
+			printf("         %6ld ms |", verdict->end - password->start);
+		else
+			printf("                 - |");
+		if(motor != NULL)
+			printf("   %6ld ms\n", motor->start - controlVerdict->end);
+		else
+			printf("        -\n");
+	}
+	if(n == 0)
+	{
+		printf(" (no PASSWORD frame in the HMI trace)\n");
+	}
+}
+
+int main(int argc, char **argv)
+{
+	long toControl;
+	long toHmi;
+	long offset = NO_TIME;
+	int i;
+
+	if(argc < 2)
+	{
+		fprintf(stderr, "usage: %s <capture> [capture ...]\n", argv[0]);
+		return 1;
+	}
+	for(i=1 ; i<argc ; ++i)
+	{
+		readCapture(argv[i]);
+	}
+
+	buildFrames(&g_hmi);
+	buildFrames(&g_control);
+	printf("HMI trace    : %u bytes (%lu lost), %u frames sent, %u received\n",
+			g_hmi.count, (unsigned long)g_hmi.lost, g_hmi.txCount, g_hmi.rxCount);
+	printf("Control trace: %u bytes (%lu lost), %u frames sent, %u received\n",
+			g_control.count, (unsigned long)g_control.lost, g_control.txCount, g_control.rxCount);
+
+	/* The two ECU clocks are independent: the offset comes from the frames seen on both sides, assuming
+	 * the same line delay in both directions ( offset = (min d1 - min d2) / 2 ) */
+	toControl = minDelay(g_hmi.tx, g_hmi.txCount, g_control.rx, g_control.rxCount);
+	toHmi = minDelay(g_control.tx, g_control.txCount, g_hmi.rx, g_hmi.rxCount);
+	if((toControl != NO_TIME) && (toHmi != NO_TIME))
+	{
+		offset = (toControl - toHmi) / 2;
+	}
+	else if(toControl != NO_TIME)
+	{
+		offset = toControl;
+	}
+	else if(toHmi != NO_TIME)
+	{
+		offset = -toHmi;
+	}
+	if(offset != NO_TIME)
+	{
+		printf("Clock offset : Control = HMI %+ld ms\n", offset);
+	}
+	else
+	{
+		printf("Clock offset : unknown (no frame in both traces), Control columns skipped\n");
+	}
+
+	printTransactions(offset);
+	return 0;
+}
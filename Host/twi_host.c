@@ -0,0 +1,428 @@
+/******************************************************************************************************
+File Name	: twi_host.c
+Author		: Sherif Beshr
+Description : Host (Linux) build of the TWI driver ( twi.h API ) on an emulated 24C16 EEPROM, so
+			  external_eeprom.c and the modules above it run unchanged on a PC. The EEPROM is modelled
+			  byte by byte as on the bus:
+			  - device address 1010 A10 A9 A8 R/W, any other device doesn't acknowledge
+			  - write: word address then up to a page of data, the address wraps inside the page
+			    ( the bytes sent beyond 16 overwrite the first ones ), written at the stop
+			  - internal write cycle after the stop: the address isn't acknowledged for
+			    EMU_WRITE_CYCLE_US of bus time ( acknowledge polling )
+			  - read: from the address counter, sequential reads wrap around the whole memory
+			  The time is the bus time at the SCL frequency: it advances with the traffic and with the
+			  idle time of TWI_emuIdle only, so the measures don't depend on the PC.
+*******************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "twi_host.h"
+
+/***************************************************************************************************
+ *                                		Types Decelerations                                  	   *
+ ***************************************************************************************************/
+
+/*	Step of the EEPROM in the running transaction	*/
+typedef enum
+{
+	EMU_IDLE, EMU_DEVICE_ADDRESS, EMU_WORD_ADDRESS, EMU_WRITE, EMU_READ, EMU_NOT_ADDRESSED
+}EMU_State;
+
+/***************************************************************************************************
+ *                                		Global Variables                                    	   *
+ ***************************************************************************************************/
+
+static uint8 *g_memory = NULL_PTR;
+static uint32 g_wear[EMU_SIZE];					/* Write cycles per cell */
+static TWI_EmuStats g_stats;
+
+static EMU_State g_state = EMU_IDLE;
+static uint8 g_status = TWI_NO_INFO;
+static uint16 g_address = 0;					/* Address counter of the EEPROM */
+static uint8 g_page[EMU_PAGE_SIZE];				/* Page buffer */
+static uint16 g_loaded = 0;						/* Bits of the page buffer loaded since the word address */
+static uint8 g_count = 0;						/* Bytes sent after the word address */
+static uint64 g_nowNs = 0;						/* Bus time since TWI_emuOpen */
+static uint64 g_busyUntilNs = 0;				/* End of the internal write cycle */
+static uint32 g_bitNs = 2500;					/* SCL period ( 400 KHz ) */
+
+/* Asynchronous transactions, run one after the other by the first TWI_submit */
+static TWI_Transaction *g_queue[TWI_QUEUE_SIZE];
+static uint8 g_queueHead = 0;
+static uint8 g_queueTail = 0;
+static uint8 g_running = FALSE;
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Maps the memory of the EEPROM on a file ( created erased if new ) or on anonymous memory. Resets the
+ * counters and the wear. Returns FALSE if the file can't be mapped.
+ */
+uint8 TWI_emuOpen(const char *path)
+{
+	struct stat st;
+	uint8 *memory;
+	int fd;
+
+	if(path == NULL_PTR)
+	{
+		memory = mmap(NULL, EMU_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+		if(memory == MAP_FAILED)
+		{
+			return FALSE;
+		}
+		memset(memory, 0xFF, EMU_SIZE);
+	}
+	else
+	{
+		fd = open(path, O_RDWR | O_CREAT, 0644);
+		if((fd < 0) || (fstat(fd, &st) < 0) || (ftruncate(fd, EMU_SIZE) < 0))
+		{
+			perror(path);
+			return FALSE;
+		}
+		memory = mmap(NULL, EMU_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		close(fd);
+		if(memory == MAP_FAILED)
+		{
+			perror(path);
+			return FALSE;
+		}
+		if(st.st_size < EMU_SIZE)
+		{
+			memset(&memory[st.st_size], 0xFF, EMU_SIZE - st.st_size);		/* New cells are erased */
+		}
+	}
+
+	if(g_memory != NULL_PTR)
+	{
+		munmap(g_memory, EMU_SIZE);
+	}
+	g_memory = memory;
+	g_state = EMU_IDLE;
+	g_nowNs = 0;
+	g_busyUntilNs = 0;
+	TWI_emuResetStats();
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Returns the memory of the EEPROM ( EMU_SIZE bytes ).
+ */
+uint8 *TWI_emuMemory(void)
+{
+	if(g_memory == NULL_PTR)
+	{
+		TWI_emuOpen(NULL_PTR);
+	}
+	return g_memory;
+}
+
+/*
+ * Description :
+ * Copies the counters of the emulator.
+ */
+void TWI_emuGetStats(TWI_EmuStats *stats)
+{
+	*stats = g_stats;
+}
+
+/*
+ * Description :
+ * Clears the counters and the wear.
+ */
+void TWI_emuResetStats(void)
+{
+	memset(&g_stats, 0, sizeof(g_stats));
+	memset(g_wear, 0, sizeof(g_wear));
+}
+
+/*
+ * Description :
+ * Returns the write cycles of a cell.
+ */
+uint32 TWI_emuWear(uint16 address)
+{
+	return g_wear[address % EMU_SIZE];
+}
+
+/*
+ * Description :
+ * Advances the time of the emulator by ns of idle bus ( no traffic, no counter ) and returns it in
+ * nano seconds since TWI_emuOpen.
+ */
+uint64 TWI_emuIdle(uint32 ns)
+{
+	g_nowNs += ns;
+	return g_nowNs;
+}
+
+/*
+ * Description :
+ * Counts the bus time of bits SCL periods.
+ */
+static void EMU_busBits(uint8 bits)
+{
+	g_nowNs += (uint64)bits * g_bitNs;
+	g_stats.BusTimeNs += (uint64)bits * g_bitNs;
+}
+
+/*
+ * Description :
+ * Initialize the TWI: the bit time of the SCL frequency ( the address and pre-scalar aren't used ).
+ */
+void TWI_init(const TWI_ConfigType* Config_Ptr)
+{
+	g_bitNs = (uint32)(1000000000UL / Config_Ptr->SCL_Frequency);
+	TWI_emuMemory();
+}
+
+/*
+ * Description :
+ * Sends a start bit, or a repeated start if the bus is already taken ( a page not written yet is lost ).
+ */
+void TWI_start(void)
+{
+	g_status = (g_state == EMU_IDLE) ? TWI_START : TWI_REP_START;
+	if(g_state == EMU_IDLE)
+	{
+		++g_stats.Transactions;
+	}
+	g_state = EMU_DEVICE_ADDRESS;
+	EMU_busBits(1);
+}
+
+/*
+ * Description :
+ * Sends a stop bit: the loaded bytes of the page buffer are written, the write cycle starts.
+ */
+void TWI_stop(void)
+{
+	uint16 page = g_address & ~(EMU_PAGE_SIZE - 1);
+	uint8 i;
+
+	EMU_busBits(1);
+	if((g_state == EMU_WRITE) && (g_loaded != 0))
+	{
+		for(i=0 ; i<EMU_PAGE_SIZE ; ++i)
+		{
+			if(g_loaded & (1 << i))
+			{
+				g_memory[page + i] = g_page[i];
+				++g_wear[page + i];
+			}
+		}
+		++g_stats.WriteCycles;
+		g_busyUntilNs = g_nowNs + (uint64)EMU_WRITE_CYCLE_US * 1000;
+	}
+	g_loaded = 0;
+	g_state = EMU_IDLE;
+	g_status = TWI_NO_INFO;
+}
+
+/*
+ * Description :
+ * Sends a byte: device address, word address or data depending on the step of the EEPROM.
+ */
+void TWI_writeByte(uint8 data)
+{
+	uint8 read = data & 1;
+
+	EMU_busBits(9);
+	++g_stats.BytesSent;
+	switch(g_state)
+	{
+	case EMU_DEVICE_ADDRESS:
+		if(((data & 0xF0) != EMU_DEVICE) || (g_nowNs < g_busyUntilNs))
+		{
+			/* Other device, or in the write cycle: the address isn't acknowledged */
+			++g_stats.Nacks;
+			g_state = EMU_NOT_ADDRESSED;
+			g_status = read ? TWI_MR_SLA_R_NACK : TWI_MT_SLA_W_NACK;
+			break;
+		}
+		/* A8 A9 A10 from the device address */
+		g_address = (uint16)(((data & 0x0E) << 7) | (g_address & 0xFF));
+		g_state = read ? EMU_READ : EMU_WORD_ADDRESS;
+		g_status = read ? TWI_MT_SLA_R_ACK : TWI_MT_SLA_W_ACK;
+		break;
+	case EMU_WORD_ADDRESS:
+		g_address = (g_address & 0x0700) | data;
+		g_loaded = 0;
+		g_count = 0;
+		g_state = EMU_WRITE;
+		g_status = TWI_MT_DATA_ACK;
+		break;
+	case EMU_WRITE:
+		/* The address wraps inside the page */
+		g_page[(g_address + g_count) & (EMU_PAGE_SIZE - 1)] = data;
+		g_loaded |= (1 << ((g_address + g_count) & (EMU_PAGE_SIZE - 1)));
+		++g_count;
+		g_status = TWI_MT_DATA_ACK;
+		break;
+	default:
+		g_status = TWI_BUS_ERROR;					/* Byte sent while the EEPROM sends or isn't addressed */
+		break;
+	}
+}
+
+/*
+ * Description :
+ * Receives the byte of the address counter, which is incremented ( wraps around the memory ).
+ */
+static uint8 EMU_readByte(uint8 ack)
+{
+	uint8 data;
+
+	EMU_busBits(9);
+	if(g_state != EMU_READ)
+	{
+		g_status = TWI_BUS_ERROR;
+		return 0xFF;								/* Nobody drives SDA */
+	}
+	++g_stats.BytesReceived;
+	data = g_memory[g_address];
+	g_address = (g_address + 1) % EMU_SIZE;
+	g_status = ack ? TWI_MR_DATA_ACK : TWI_MR_DATA_NACK;
+	return data;
+}
+
+/*
+ * Description :
+ * Read a byte from slave and send ACK.
+ */
+uint8 TWI_readByteWithACK(void)
+{
+	return EMU_readByte(TRUE);
+}
+
+/*
+ * Description :
+ * Read a byte from slave and send NACK.
+ */
+uint8 TWI_readByteWithNACK(void)
+{
+	return EMU_readByte(FALSE);
+}
+
+/*
+ * Description :
+ * Read status.
+ */
+uint8 TWI_getStatus(void)
+{
+	return g_status;
+}
+
+/*
+ * Description :
+ * Runs a transaction with the blocking functions, as the TWI ISR does it on the ECU.
+ */
+static TWI_Result EMU_run(TWI_Transaction *transaction)
+{
+	uint16 i;
+
+	TWI_start();
+	TWI_writeByte(transaction->SlaveAddress);
+	if(g_status != TWI_MT_SLA_W_ACK)
+	{
+		return TWI_RESULT_ADDRESS_NACK;
+	}
+	for(i=0 ; i<transaction->SubAddressLength ; ++i)
+	{
+		TWI_writeByte(transaction->SubAddress[i]);
+	}
+	for(i=0 ; i<transaction->TxLength ; ++i)
+	{
+		TWI_writeByte(transaction->TxData[i]);
+	}
+	if(transaction->RxLength > 0)
+	{
+		TWI_start();
+		TWI_writeByte(transaction->SlaveAddress | 1);
+		if(g_status != TWI_MT_SLA_R_ACK)
+		{
+			return TWI_RESULT_ADDRESS_NACK;
+		}
+		for(i=0 ; i<transaction->RxLength ; ++i)
+		{
+			transaction->RxData[i] = EMU_readByte((i + 1) < transaction->RxLength);
+		}
+	}
+	return TWI_RESULT_OK;
+}
+
+/*
+ * Description :
+ * Queues an asynchronous transaction. The first call runs the queue until it is empty, the transactions
+ * queued by the call backs included ( no recursion ), so a transaction has ended when TWI_submit returns.
+ */
+uint8 TWI_submit(TWI_Transaction *transaction)
+{
+	TWI_Transaction *running;
+	uint8 next = (g_queueHead + 1) & (TWI_QUEUE_SIZE - 1);
+
+	if(next == g_queueTail)
+	{
+		return FALSE;
+	}
+	transaction->Result = TWI_RESULT_PENDING;
+	g_queue[g_queueHead] = transaction;
+	g_queueHead = next;
+	if(g_running)
+	{
+		return TRUE;
+	}
+
+	g_running = TRUE;
+	while(g_queueTail != g_queueHead)
+	{
+		running = g_queue[g_queueTail];
+		running->Result = EMU_run(running);
+		TWI_stop();
+		g_queueTail = (g_queueTail + 1) & (TWI_QUEUE_SIZE - 1);
+		if(running->CallBack != NULL_PTR)
+		{
+			(*running->CallBack)(running);
+		}
+	}
+	g_running = FALSE;
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Returns TRUE while asynchronous transactions are queued or running ( never outside TWI_submit ).
+ */
+uint8 TWI_isBusy(void)
+{
+	return (g_queueHead != g_queueTail);
+}
+
+/*
+ * Description :
+ * The emulated bus doesn't get stuck: only ends the transaction of the EEPROM.
+ */
+uint8 TWI_recover(void)
+{
+	g_state = EMU_IDLE;
+	g_loaded = 0;
+	return TRUE;
+}
+
+/*
+ * Description :
+ * No bus error is emulated, the counters stay at 0.
+ */
+void TWI_getStats(TWI_Stats *stats)
+{
+	memset(stats, 0, sizeof(TWI_Stats));
+}
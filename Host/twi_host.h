@@ -0,0 +1,82 @@
+/******************************************************************************************************
+File Name	: twi_host.h
+Author		: Sherif Beshr
+Description : Header file for the host (Linux) build of the TWI driver: the twi.h API on an emulated
+			  24C16 EEPROM, with the bus and wear counters of the emulator
+*******************************************************************************************************/
+
+#ifndef TWI_HOST_H_
+#define TWI_HOST_H_
+
+#include "std_types.h"
+#include "twi.h"
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+#define EMU_SIZE				2048		/* 24C16: 8 blocks of 256 bytes ( A8 A9 A10 in the device address ) */
+#define EMU_PAGE_SIZE			16
+#define EMU_DEVICE				0xA0		/* Device type of the address byte */
+#define EMU_WRITE_CYCLE_US		5000		/* Internal write cycle of a page ( tWR of the 24C16 ) */
+#define EMU_ENDURANCE			1000000UL	/* Write cycles of a cell ( 24C16 data sheet ) */
+
+/***************************************************************************************************
+ *                                		Types Decelerations                                  	   *
+ ***************************************************************************************************/
+
+/*	Counters of the emulator since TWI_emuOpen / TWI_emuResetStats	*/
+typedef struct
+{
+	uint32	Transactions;		/* Start ... stop sequences */
+	uint32	Nacks;				/* Address NACKs ( the EEPROM is in a write cycle ) */
+	uint32	BytesSent;			/* Bytes on the bus from the master, address bytes included */
+	uint32	BytesReceived;
+	uint32	WriteCycles;		/* Internal write cycles ( one per written page ) */
+	uint64	BusTimeNs;			/* Bus time at the SCL frequency of TWI_init: 9 bits per byte, start, stop */
+}TWI_EmuStats;
+
+/***************************************************************************************************
+ *                                		Function Prototypes                                 	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Maps the memory of the EEPROM on a file ( created erased, 0xFF, if it doesn't exist ) so it keeps its
+ * content between runs, or on anonymous memory if path is NULL. Resets the counters and the wear.
+ * Returns FALSE if the file can't be mapped. TWI_init maps anonymous memory if it isn't called before.
+ */
+uint8 TWI_emuOpen(const char *path);
+
+/*
+ * Description :
+ * Returns the memory of the EEPROM ( EMU_SIZE bytes ).
+ */
+uint8 *TWI_emuMemory(void);
+
+/*
+ * Description :
+ * Copies the counters of the emulator.
+ */
+void TWI_emuGetStats(TWI_EmuStats *stats);
+
+/*
+ * Description :
+ * Clears the counters and the wear.
+ */
+void TWI_emuResetStats(void);
+
+/*
+ * Description :
+ * Returns the write cycles of a cell.
+ */
+uint32 TWI_emuWear(uint16 address);
+
+/*
+ * Description :
+ * Advances the time of the emulator by ns of idle bus ( no traffic, no counter ) and returns it in
+ * nano seconds since TWI_emuOpen.
+ */
+uint64 TWI_emuIdle(uint32 ns);
+
+#endif /* TWI_HOST_H_ */
@@ -0,0 +1,346 @@
+/******************************************************************************************************
+File Name	: uart_pty.c
+Author		: Sherif Beshr
+Description : Host (Linux) build of the UART driver: the uart.h API on a pseudo terminal, so frame.c
+			  and link.c of both ECUs run unchanged on a PC. The PTY is taken from the UART_PTY
+			  environment variable (a slave printed by pty_bridge). The baud rate is stored in the
+			  PTY settings (termios2, any rate) where pty_bridge reads it to pace the bytes.
+*******************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <asm/termbits.h>
+#include "uart.h"
+#include "timebase.h"
+
+/***************************************************************************************************
+ *                                		Global Variables                                    	   *
+ ***************************************************************************************************/
+
+/* Same rates as the table of uart.c (bit n of the supported mask is entry n) */
+static const UART_BaudRate g_baudRates[] =
+{
+	Baud_2400,	Baud_4800,	Baud_9600,	Baud_14400,	Baud_19200,	Baud_28800,	Baud_38400,
+	Baud_57600,	Baud_76800,	Baud_115200, Baud_230400, Baud_250k, Baud_500k, Baud_1M
+};
+#define UART_BAUD_COUNT					(sizeof(g_baudRates) / sizeof(g_baudRates[0]))
+
+static int g_fd = -1;
+static UART_BaudRate g_baud = UART_START_BAUD;
+static long long g_txDoneUs = 0;			/* Time the last byte written is out on the emulated line */
+static void (*g_rxCallBackPtr)(uint8) = NULL_PTR;
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * Returns the monotonic time in microseconds.
+ */
+static long long UART_nowUs(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (long long)now.tv_sec * 1000000LL + now.tv_nsec / 1000;
+}
+
+/*
+ * Description :
+ * Returns TRUE if the rate is within tolerance at F_CPU and not above UART_MAX_BAUD (as on the ECU).
+ */
+static uint8 UART_isSupported(UART_BaudRate baud)
+{
+	return UART_BAUD_IS_VALID((unsigned long)baud) && ((unsigned long)baud <= UART_MAX_BAUD);
+}
+
+/*
+ * Description :
+ * Waits up to timeout_ms for a byte from the PTY. Returns TRUE and stores it if one arrived.
+ */
+static uint8 UART_readByte(uint8 *data, int timeout_ms)
+{
+	struct pollfd pfd = { g_fd, POLLIN, 0 };
+
+	if((poll(&pfd, 1, timeout_ms) > 0) && (read(g_fd, data, 1) == 1))
+	{
+		return TRUE;
+	}
+	return FALSE;
+}
+
+/*
+ * Description :
+ * Opens the PTY of UART_PTY in raw mode (8 data bits, no parity) at the required rate.
+ */
+void UART_init(const UART_ConfigType* Config_Ptr)
+{
+	struct termios2 tio;
+	const char *name = getenv("UART_PTY");
+
+	if(name == NULL)
+	{
+		fprintf(stderr, "UART_PTY is not set (slave PTY printed by pty_bridge)\n");
+		exit(1);
+	}
+	g_fd = open(name, O_RDWR | O_NOCTTY);
+	if((g_fd < 0) || (ioctl(g_fd, TCGETS2, &tio) < 0))
+	{
+		perror(name);
+		exit(1);
+	}
+	tio.c_iflag = 0;
+	tio.c_oflag = 0;
+	tio.c_lflag = 0;
+	tio.c_cflag = CS8 | CREAD | CLOCAL;
+	tio.c_cc[VMIN] = 1;
+	tio.c_cc[VTIME] = 0;
+	ioctl(g_fd, TCSETS2, &tio);
+
+	if(!UART_setBaudRate(Config_Ptr->BaudRate))
+	{
+		UART_setBaudRate(UART_START_BAUD);
+	}
+}
+
+/*
+ * Description :
+ * Changes the baud rate of the PTY (read by pty_bridge). Returns FALSE if the ECU couldn't use it.
+ */
+uint8 UART_setBaudRate(UART_BaudRate baud)
+{
+	struct termios2 tio;
+
+	if(!UART_isSupported(baud))
+	{
+		return FALSE;
+	}
+	UART_flushTx();
+	ioctl(g_fd, TCGETS2, &tio);
+	tio.c_cflag = (tio.c_cflag & ~CBAUD) | BOTHER;
+	tio.c_ispeed = baud;
+	tio.c_ospeed = baud;
+	ioctl(g_fd, TCSETS2, &tio);
+	g_baud = baud;
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Returns the baud rates this ECU supports as a mask, bit n is the n-th rate of UART_BaudRate.
+ */
+uint16 UART_getSupportedBauds(void)
+{
+	uint16 mask = 0;
+	uint8 i;
+
+	for(i=0 ; i<UART_BAUD_COUNT ; ++i)
+	{
+		if(UART_isSupported(g_baudRates[i]))
+		{
+			mask |= (1<<i);
+		}
+	}
+	return mask;
+}
+
+/*
+ * Description :
+ * Returns the highest baud rate in a mask of UART_getSupportedBauds, UART_START_BAUD if it is empty.
+ */
+UART_BaudRate UART_getHighestBaud(uint16 mask)
+{
+	uint8 i = UART_BAUD_COUNT;
+
+	mask &= UART_getSupportedBauds();
+	while(i > 0)
+	{
+		--i;
+		if(mask & (1<<i))
+		{
+			return g_baudRates[i];
+		}
+	}
+	return UART_START_BAUD;
+}
+
+/*
+ * Description :
+ * Returns the next higher supported baud rate, after the highest one it wraps to the lowest one.
+ */
+UART_BaudRate UART_getNextBaud(UART_BaudRate baud)
+{
+	uint8 i;
+
+	for(i=0 ; i<UART_BAUD_COUNT ; ++i)
+	{
+		if((g_baudRates[i] > baud) && UART_isSupported(g_baudRates[i]))
+		{
+			return g_baudRates[i];
+		}
+	}
+	for(i=0 ; i<UART_BAUD_COUNT ; ++i)
+	{
+		if(UART_isSupported(g_baudRates[i]))
+		{
+			break;
+		}
+	}
+	return g_baudRates[i];
+}
+
+/*
+ * Description :
+ * Blocks until the bytes written are out at the current rate, as UART_flushTx waits for TXC on the ECU.
+ * tcdrain doesn't wait for the bridge on a PTY, and the bridge reads the rate of a byte when it takes
+ * it: a rate change right after the write would garble the last bytes.
+ */
+void UART_flushTx(void)
+{
+	long long wait = g_txDoneUs - UART_nowUs();
+
+	if(wait > 0)
+	{
+		usleep((useconds_t)wait);
+	}
+}
+
+/*
+ * Description :
+ * The MPCM bus isn't emulated by the bridge, the host link is always point to point.
+ */
+void UART_setNodeAddress(uint8 address)
+{
+	(void)address;
+}
+
+void UART_sendAddress(uint8 address)
+{
+	(void)address;
+}
+
+uint8 UART_isAddressed(void)
+{
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Sends one byte to the PTY.
+ */
+void UART_sendByte(const uint8 data)
+{
+	long long now = UART_nowUs();
+
+	while(write(g_fd, &data, 1) != 1){}
+	if(g_txDoneUs < now)
+	{
+		g_txDoneUs = now;
+	}
+	g_txDoneUs += (10 * 1000000LL) / g_baud;	/* Start + 8 data + stop */
+}
+
+/*
+ * Description :
+ * Blocks until a byte is received.
+ */
+uint8 UART_receiveByte(void)
+{
+	uint8 data;
+
+	while(!UART_readByte(&data, -1)){}
+	return data;
+}
+
+/*
+ * Description :
+ * Waits up to timeout_ms milliseconds for a byte. Returns TRUE and stores it if it arrived in time.
+ */
+uint8 UART_receiveByteTimeout(uint16 timeout_ms, uint8 *data)
+{
+	return UART_readByte(data, timeout_ms);
+}
+
+/*
+ * Description :
+ * Non-blocking send, the PTY always accepts the byte.
+ */
+uint8 UART_queueSend(const uint8 data)
+{
+	UART_sendByte(data);
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Non-blocking receive. Returns TRUE and stores the byte in data if one is available.
+ */
+uint8 UART_tryReceive(uint8 *data)
+{
+	return UART_readByte(data, 0);
+}
+
+/*
+ * Description :
+ * Takes the place of the RXC ISR: passes the received bytes to the call back function. Waits up to
+ * 1 ms when nothing arrived so the busy waits of the link don't take a whole host CPU.
+ */
+void UART_rxPoll(void)
+{
+	uint8 data;
+	int timeout_ms = 1;
+
+	if(g_rxCallBackPtr == NULL_PTR)
+	{
+		return;
+	}
+	while(UART_readByte(&data, timeout_ms))
+	{
+		(*g_rxCallBackPtr)(data);
+		timeout_ms = 0;
+	}
+}
+
+/*
+ * Description: Function to set the receive Call Back function address, called from UART_rxPoll.
+ */
+void UART_setRxCallBack(void(*a_ptr)(uint8))
+{
+	g_rxCallBackPtr = a_ptr;
+}
+
+/*
+ * Description :
+ * Send the required string through UART to the other UART device.
+ */
+void UART_sendString(const uint8 *Str)
+{
+	while(*Str != '\0')
+	{
+		UART_sendByte(*Str);
+		Str++;
+	}
+}
+
+/*
+ * Description :
+ * Receive the required string until the '#' symbol through UART from the other UART device.
+ */
+void UART_receiveString(uint8 *Str)
+{
+	uint8 i = 0;
+
+	Str[i] = UART_receiveByte();
+	while(Str[i] != '#')
+	{
+		i++;
+		Str[i] = UART_receiveByte();
+	}
+	Str[i] = '\0';
+}
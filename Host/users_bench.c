@@ -0,0 +1,152 @@
+/******************************************************************************************************
+File Name	: users_bench.c
+Author		: Sherif Beshr
+Description : Host (Linux) benchmark of the user table of the Control ECU ( user_table.c unchanged ) on
+			  an EEPROM kept in memory. For 10, 100 and 500 users it verifies every PIN and a wrong one
+			  and prints the index probes, the slots read and the TWI bus time at 400 kHz, next to the
+			  bus time of a linear scan of the table. Built with USERS_MAX = 512 on a bigger EEPROM than
+			  the 24C16 ( 63 users on the ECU ). The host time includes the PIN digest ( digest.c ).
+Usage		: users_bench
+*******************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "std_types.h"
+#include "external_eeprom.h"
+#include "user_table.h"
+
+/***************************************************************************************************
+ *                                		Definitions                                  			   *
+ ***************************************************************************************************/
+
+#define BENCH_SCL_HZ			400000UL
+#define BENCH_ADDRESS_BYTES		3			/* SLA+W, word address, SLA+R of a read */
+#define BENCH_PIN_DIGITS		11			/* Longest random PIN */
+
+/***************************************************************************************************
+ *                                		Global Variables                                    	   *
+ ***************************************************************************************************/
+
+static uint8 g_memory[USERS_EEPROM_SIZE];
+static unsigned long g_busBits = 0;			/* TWI bits of the reads since the last reset */
+
+/***************************************************************************************************
+ *                                		Function Definitions                                  	   *
+ ***************************************************************************************************/
+
+/*
+ * Description :
+ * EEPROM driver on g_memory, the reads count their TWI bits ( 9 per byte, start / stop ).
+ */
+uint8 EEPROM_readBlock(uint16 u16addr, uint8 *u8data, uint16 len)
+{
+	memcpy(u8data, &g_memory[u16addr], len);
+	g_busBits += (BENCH_ADDRESS_BYTES + len) * 9 + 3;
+	return SUCCESS;
+}
+
+uint8 EEPROM_writePage(uint16 u16addr, const uint8 *u8data, uint16 len)
+{
+	memcpy(&g_memory[u16addr], u8data, len);
+	return SUCCESS;
+}
+
+uint8 EEPROM_readByte(uint16 u16addr, uint8 *u8data)
+{
+	*u8data = g_memory[u16addr];
+	g_busBits += (BENCH_ADDRESS_BYTES + 1) * 9 + 3;
+	return SUCCESS;
+}
+
+uint8 EEPROM_writeByte(uint16 u16addr, uint8 u8data)
+{
+	g_memory[u16addr] = u8data;
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * Writes a random PIN of 6 to 11 digits, returns its length.
+ */
+static uint8 randomPin(uint8 *pin)
+{
+	uint8 length = 6 + rand() % (BENCH_PIN_DIGITS - 5);
+	uint8 i;
+
+	for(i=0 ; i<length ; ++i)
+	{
+		pin[i] = '0' + rand() % 10;
+	}
+	return length;
+}
+
+/*
+ * Description :
+ * Fills a table with n users and measures the verification of every PIN and of a wrong one.
+ */
+static void benchUsers(uint16 n)
+{
+	static uint8 pins[USERS_MAX][BENCH_PIN_DIGITS];
+	static uint8 lengths[USERS_MAX];
+	USERS_Stats stats;
+	unsigned long probes = 0;
+	unsigned long reads = 0;
+	unsigned long maxProbes = 0;
+	unsigned long bits;
+	struct timespec start;
+	struct timespec end;
+	uint8 wrong[BENCH_PIN_DIGITS];
+	uint8 wrongLength;
+	uint16 i;
+
+	memset(g_memory, 0xFF, sizeof(g_memory));
+	USERS_init();
+	for(i=0 ; i<n ; ++i)
+	{
+		do
+		{
+			lengths[i] = randomPin(pins[i]);
+		}while(USERS_add(i + 1, pins[i], lengths[i]) != USERS_OK);
+	}
+	USERS_init();								/* Index built from the table as at boot */
+
+	g_busBits = 0;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(i=0 ; i<n ; ++i)
+	{
+		if(USERS_verify(pins[i], lengths[i]) != (i + 1))
+		{
+			printf("user %u not verified\n", i + 1);
+		}
+		USERS_getStats(&stats);
+		probes += stats.Probes;
+		reads += stats.SlotReads;
+		maxProbes = (stats.Probes > maxProbes) ? stats.Probes : maxProbes;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	bits = g_busBits / n;
+
+	do
+	{
+		wrongLength = randomPin(wrong);
+	}while(USERS_verify(wrong, wrongLength) != USERS_NO_USER);
+	USERS_getStats(&stats);
+
+	printf("%4u users | probes avg %4.1f max %2lu | slot reads %.2f | bus %4lu us | wrong PIN: %u probes %u reads"
+			" | linear scan %6lu us | host %4.0f ns\n",
+			n, (double)probes / n, maxProbes, (double)reads / n, (bits * 1000000UL) / BENCH_SCL_HZ,
+			stats.Probes, stats.SlotReads,
+			((unsigned long)n * ((BENCH_ADDRESS_BYTES + USERS_SLOT_SIZE) * 9 + 3) * 1000000UL) / BENCH_SCL_HZ,
+			((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / n);
+}
+
+int main(void)
+{
+	srand(1);
+	benchUsers(10);
+	benchUsers(100);
+	benchUsers(500);
+	return 0;
+}